@@ -25,6 +25,14 @@ namespace gps {
         return glm::lookAt(cameraPosition, cameraTarget, cameraUpDirection);
     }
 
+    glm::mat4 Camera::getViewMatrixAt(const glm::vec3& position, const glm::vec3& front) const
+    {
+        // up from front, as in updateCameraVectors
+        glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+        glm::vec3 up = glm::normalize(glm::cross(right, front));
+        return glm::lookAt(position, position + front, up);
+    }
+
     void Camera::move(MOVE_DIRECTION direction, float speed)
     {
         glm::vec3 forward = glm::normalize(cameraFrontDirection);
@@ -14,6 +14,9 @@ namespace gps {
         Camera(glm::vec3 cameraPosition, glm::vec3 cameraTarget, glm::vec3 cameraUp);
 
         glm::mat4 getViewMatrix();
+        // view from an arbitrary (e.g. interpolated) position / front, same up convention;
+        // reads no camera state, so the render thread may call it while the camera moves
+        glm::mat4 getViewMatrixAt(const glm::vec3& position, const glm::vec3& front) const;
 
         void move(MOVE_DIRECTION direction, float speed);
         void rotate(float pitchDelta, float yawDelta);
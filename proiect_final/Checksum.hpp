@@ -0,0 +1,48 @@
+#ifndef Checksum_hpp
+#define Checksum_hpp
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gps {
+
+    // The two checksums of a PNG file: CRC-32 per chunk, Adler-32 at the end of the zlib stream.
+    // Both can be continued over several buffers by passing the previous result back in.
+
+    struct Crc32Table {
+        uint32_t entries[256];
+    };
+
+    // built at compile time: the encoder threads share it without any initialization race
+    constexpr Crc32Table makeCrc32Table()
+    {
+        Crc32Table table = {};
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table.entries[n] = c;
+        }
+        return table;
+    }
+
+    inline constexpr Crc32Table kCrc32Table = makeCrc32Table();
+
+    inline uint32_t crc32(const unsigned char* data, size_t size, uint32_t crc = 0)
+    {
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++) crc = kCrc32Table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    inline uint32_t adler32(const unsigned char* data, size_t size, uint32_t adler = 1)
+    {
+        uint32_t a = adler & 0xFFFF, b = adler >> 16;
+        for (size_t i = 0; i < size; i++) {
+            a = (a + data[i]) % 65521u;
+            b = (b + a) % 65521u;
+        }
+        return (b << 16) | a;
+    }
+}
+
+#endif /* Checksum_hpp */
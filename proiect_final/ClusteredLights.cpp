@@ -0,0 +1,316 @@
+#include "ClusteredLights.hpp"
+#include "CpuProfiler.hpp"
+#include "JobSystem.hpp"
+#include "StreamBuffer.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+namespace gps {
+
+    static void createBufferTexture(GLuint& buffer, GLuint& texture, GLenum format)
+    {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // orphan + refill (the driver hands us fresh storage, no sync with last frame's draws)
+    static void streamBuffer(GLuint buffer, const void* data, size_t bytes)
+    {
+        static const GLuint zero[4] = { 0, 0, 0, 0 };
+        if (bytes == 0) {
+            data = zero;
+            bytes = sizeof(zero);
+        }
+
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+#if !defined (__APPLE__)
+    // ring allocation bound as the texture's range; false (nothing bound) when the ring is full
+    static bool streamRange(StreamBuffer& stream, GLuint texture, GLenum format, const void* data, size_t bytes,
+        GLint alignment)
+    {
+        static const GLuint zero[4] = { 0, 0, 0, 0 };
+        if (bytes == 0) {
+            data = zero;
+            bytes = sizeof(zero);
+        }
+
+        StreamBuffer::Allocation allocation = stream.upload(data, (GLsizeiptr)bytes, alignment);
+        if (!allocation.isValid()) return false;
+
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBufferRange(GL_TEXTURE_BUFFER, format, stream.getBuffer(), allocation.offset, allocation.size);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        return true;
+    }
+
+    // back from a ring range to the texture's own buffer
+    static void streamOwn(GLuint buffer, GLuint texture, GLenum format, const void* data, size_t bytes)
+    {
+        streamBuffer(buffer, data, bytes);
+
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+#endif
+
+    static bool sphereIntersectsAABB(const glm::vec3& c, float r, const glm::vec3& bmin, const glm::vec3& bmax)
+    {
+        float d2 = 0.0f;
+        for (int i = 0; i < 3; i++) {
+            if (c[i] < bmin[i]) d2 += (bmin[i] - c[i]) * (bmin[i] - c[i]);
+            else if (c[i] > bmax[i]) d2 += (c[i] - bmax[i]) * (c[i] - bmax[i]);
+        }
+        return d2 <= r * r;
+    }
+
+    ClusteredLights::~ClusteredLights()
+    {
+        if (lightTexture) glDeleteTextures(1, &lightTexture);
+        if (gridTexture) glDeleteTextures(1, &gridTexture);
+        if (indexTexture) glDeleteTextures(1, &indexTexture);
+        if (lightBuffer) glDeleteBuffers(1, &lightBuffer);
+        if (gridBuffer) glDeleteBuffers(1, &gridBuffer);
+        if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+    }
+
+    void ClusteredLights::init(int tilesX, int tilesY, int slicesZ)
+    {
+        this->tilesX = tilesX;
+        this->tilesY = tilesY;
+        this->slicesZ = std::max(2, slicesZ);
+
+        size_t clusterCount = (size_t)tilesX * tilesY * this->slicesZ;
+        clusterCounts.assign(clusterCount, 0);
+        clusterScratch.assign(clusterCount * kMaxLightsPerCluster, 0);
+        clusterGrid.assign(clusterCount * 2, 0);
+
+        createBufferTexture(lightBuffer, lightTexture, GL_RGBA32F);
+        createBufferTexture(gridBuffer, gridTexture, GL_RG32UI);
+        createBufferTexture(indexBuffer, indexTexture, GL_R32UI);
+    }
+
+    int ClusteredLights::sliceOf(float viewZ) const
+    {
+        if (viewZ < kNearSliceZ) return 0;
+        int s = 1 + (int)std::floor(std::log(viewZ / kNearSliceZ) * logScale);
+        return std::min(s, slicesZ - 1);
+    }
+
+    float ClusteredLights::sliceStart(int slice) const
+    {
+        if (slice <= 0) return zNear;
+        return kNearSliceZ * std::exp((float)(slice - 1) / logScale);
+    }
+
+    void ClusteredLights::setProjection(float fovyRadians, float aspect, float zNear, float zFar,
+        int viewportWidth, int viewportHeight)
+    {
+        this->zNear = zNear;
+        this->zFar = zFar;
+        logScale = (float)(slicesZ - 1) / std::log(kClusterFar / kNearSliceZ);
+
+        // one tile size per axis: the grid covers the whole viewport at any aspect ratio
+        tileSizePx.x = std::max(1, (viewportWidth + tilesX - 1) / tilesX);
+        tileSizePx.y = std::max(1, (viewportHeight + tilesY - 1) / tilesY);
+
+        float tanY = std::tan(fovyRadians * 0.5f);
+        float tanX = tanY * aspect;
+
+        clusterBounds.resize((size_t)tilesX * tilesY * slicesZ);
+
+        for (int z = 0; z < slicesZ; z++) {
+            float d0 = sliceStart(z);
+            // the last slice also catches everything past kClusterFar (see the shader)
+            float d1 = (z == slicesZ - 1) ? zFar : sliceStart(z + 1);
+
+            for (int y = 0; y < tilesY; y++) {
+                float ndcY0 = 2.0f * (float)(y * tileSizePx.y) / (float)viewportHeight - 1.0f;
+                float ndcY1 = 2.0f * (float)((y + 1) * tileSizePx.y) / (float)viewportHeight - 1.0f;
+
+                for (int x = 0; x < tilesX; x++) {
+                    float ndcX0 = 2.0f * (float)(x * tileSizePx.x) / (float)viewportWidth - 1.0f;
+                    float ndcX1 = 2.0f * (float)((x + 1) * tileSizePx.x) / (float)viewportWidth - 1.0f;
+
+                    ClusterBounds b;
+                    b.minP = glm::vec3(FLT_MAX);
+                    b.maxP = glm::vec3(-FLT_MAX);
+
+                    const float depths[2] = { d0, d1 };
+                    const float xs[2] = { ndcX0 * tanX, ndcX1 * tanX };
+                    const float ys[2] = { ndcY0 * tanY, ndcY1 * tanY };
+                    for (float d : depths)
+                        for (float px : xs)
+                            for (float py : ys) {
+                                glm::vec3 p(px * d, py * d, -d);
+                                b.minP = glm::min(b.minP, p);
+                                b.maxP = glm::max(b.maxP, p);
+                            }
+
+                    clusterBounds[((size_t)z * tilesY + y) * tilesX + x] = b;
+                }
+            }
+        }
+    }
+
+    void ClusteredLights::buildSlices(int sliceBegin, int sliceEnd)
+    {
+        WT_PROFILE_FUNCTION();
+
+        const int tilesPerSlice = tilesX * tilesY;
+
+        for (int z = sliceBegin; z < sliceEnd; z++) {
+            size_t first = (size_t)z * tilesPerSlice;
+            std::fill(clusterCounts.begin() + first, clusterCounts.begin() + first + tilesPerSlice, 0u);
+
+            for (GLuint li = 0; li < (GLuint)eyeLights.size(); li++) {
+                const EyeLight& L = eyeLights[li];
+                if (z < L.sliceMin || z > L.sliceMax) continue;
+
+                for (int t = 0; t < tilesPerSlice; t++) {
+                    size_t c = first + t;
+                    const ClusterBounds& b = clusterBounds[c];
+                    if (!sphereIntersectsAABB(L.posEye, L.radius, b.minP, b.maxP)) continue;
+
+                    GLuint& count = clusterCounts[c];
+                    if (count < (GLuint)kMaxLightsPerCluster) {
+                        clusterScratch[c * kMaxLightsPerCluster + count] = li;
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+
+    void ClusteredLights::build(const glm::mat4& view, const std::vector<PointLight>& lights)
+    {
+        WT_PROFILE_FUNCTION();
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        // 1) lights to eye space, drop the ones outside the clustered depth range
+        eyeLights.clear();
+        lightData.clear();
+        for (const auto& L : lights) {
+            glm::vec3 pEye = glm::vec3(view * glm::vec4(L.position, 1.0f));
+            float viewZ = -pEye.z;
+            if (viewZ + L.radius < zNear) continue;
+            if (viewZ - L.radius > kClusterFar) continue;
+
+            EyeLight e;
+            e.posEye = pEye;
+            e.radius = L.radius;
+            e.sliceMin = sliceOf(std::max(viewZ - L.radius, zNear));
+            e.sliceMax = sliceOf(viewZ + L.radius);
+            eyeLights.push_back(e);
+
+            lightData.push_back(glm::vec4(pEye.x, pEye.y, pEye.z, L.radius));
+            lightData.push_back(glm::vec4(L.color.r, L.color.g, L.color.b, 0.0f));
+        }
+        lightCount = eyeLights.size();
+
+        // 2) light -> froxel assignment, depth slices split over the job system
+        //    (slices write disjoint cluster ranges, so chunks need no synchronisation)
+        if (!jobs || eyeLights.size() < 32) {   // not worth the hand-off
+            buildSlices(0, slicesZ);
+        }
+        else {
+            jobs->parallelFor((size_t)slicesZ, 1, [this](size_t begin, size_t end) {
+                buildSlices((int)begin, (int)end);
+            });
+        }
+
+        // 3) compact the fixed-size per-cluster lists into (offset, count) + one index list
+        lightIndices.clear();
+        maxLightsInCluster = 0;
+        size_t clusterCount = clusterCounts.size();
+        for (size_t c = 0; c < clusterCount; c++) {
+            GLuint count = clusterCounts[c];
+            clusterGrid[2 * c + 0] = (GLuint)lightIndices.size();
+            clusterGrid[2 * c + 1] = count;
+            lightIndices.insert(lightIndices.end(),
+                clusterScratch.begin() + c * kMaxLightsPerCluster,
+                clusterScratch.begin() + c * kMaxLightsPerCluster + count);
+            maxLightsInCluster = std::max(maxLightsInCluster, (int)count);
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+        lastBuildMs = std::chrono::duration<float, std::milli>(t1 - t0).count();
+    }
+
+    void ClusteredLights::setStreamBuffer(StreamBuffer* stream)
+    {
+        this->stream = nullptr;
+#if !defined (__APPLE__)
+        if (stream && GLEW_ARB_texture_buffer_range) {
+            this->stream = stream;
+            glGetIntegerv(GL_TEXTURE_BUFFER_OFFSET_ALIGNMENT, &texelAlignment);
+        }
+#endif
+    }
+
+    void ClusteredLights::upload()
+    {
+        if (stream) return;
+
+        streamBuffer(lightBuffer, lightData.data(), lightData.size() * sizeof(glm::vec4));
+        streamBuffer(gridBuffer, clusterGrid.data(), clusterGrid.size() * sizeof(GLuint));
+        streamBuffer(indexBuffer, lightIndices.data(), lightIndices.size() * sizeof(GLuint));
+    }
+
+    void ClusteredLights::commitFrame()
+    {
+#if !defined (__APPLE__)
+        if (!stream) return;
+
+        if (!streamRange(*stream, lightTexture, GL_RGBA32F, lightData.data(), lightData.size() * sizeof(glm::vec4), texelAlignment))
+            streamOwn(lightBuffer, lightTexture, GL_RGBA32F, lightData.data(), lightData.size() * sizeof(glm::vec4));
+        if (!streamRange(*stream, gridTexture, GL_RG32UI, clusterGrid.data(), clusterGrid.size() * sizeof(GLuint), texelAlignment))
+            streamOwn(gridBuffer, gridTexture, GL_RG32UI, clusterGrid.data(), clusterGrid.size() * sizeof(GLuint));
+        if (!streamRange(*stream, indexTexture, GL_R32UI, lightIndices.data(), lightIndices.size() * sizeof(GLuint), texelAlignment))
+            streamOwn(indexBuffer, indexTexture, GL_R32UI, lightIndices.data(), lightIndices.size() * sizeof(GLuint));
+#endif
+    }
+
+    void ClusteredLights::bind(int firstUnit)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 0);
+        glBindTexture(GL_TEXTURE_BUFFER, lightTexture);
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+        glBindTexture(GL_TEXTURE_BUFFER, gridTexture);
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 2);
+        glBindTexture(GL_TEXTURE_BUFFER, indexTexture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void ClusteredLights::setUniforms(GLuint program, int firstUnit)
+    {
+        glUseProgram(program);
+
+        GLint loc;
+        if ((loc = glGetUniformLocation(program, "pointLights")) != -1) glUniform1i(loc, firstUnit + 0);
+        if ((loc = glGetUniformLocation(program, "clusterGrid")) != -1) glUniform1i(loc, firstUnit + 1);
+        if ((loc = glGetUniformLocation(program, "clusterLightIndices")) != -1) glUniform1i(loc, firstUnit + 2);
+
+        if ((loc = glGetUniformLocation(program, "clusterDims")) != -1) glUniform3i(loc, tilesX, tilesY, slicesZ);
+        if ((loc = glGetUniformLocation(program, "clusterTileSize")) != -1) glUniform2f(loc, (float)tileSizePx.x, (float)tileSizePx.y);
+        if ((loc = glGetUniformLocation(program, "clusterNearSliceZ")) != -1) glUniform1f(loc, kNearSliceZ);
+        if ((loc = glGetUniformLocation(program, "clusterLogScale")) != -1) glUniform1f(loc, logScale);
+    }
+}
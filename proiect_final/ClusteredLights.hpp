@@ -0,0 +1,114 @@
+#ifndef ClusteredLights_hpp
+#define ClusteredLights_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace gps {
+
+    class JobSystem;
+    class StreamBuffer;
+
+    struct PointLight {
+        glm::vec3 position;     // WORLD
+        glm::vec3 color;
+        float radius;           // WORLD units, the light fades to 0 at this distance
+    };
+
+    // Clustered forward lighting: the view frustum is split into tilesX * tilesY * slicesZ
+    // froxels (exponential depth slices); each froxel gets the list of lights touching it.
+    // The grid is built on the CPU (split over the job system by depth slice) and read by
+    // shaderPPL.frag from three buffer textures.
+    class ClusteredLights {
+
+    public:
+        ~ClusteredLights();
+
+        void init(int tilesX, int tilesY, int slicesZ);
+        // null: build() runs on the calling thread only
+        void setJobSystem(JobSystem* jobs) { this->jobs = jobs; }
+
+        // must be called again on resize / projection change
+        void setProjection(float fovyRadians, float aspect, float zNear, float zFar,
+            int viewportWidth, int viewportHeight);
+
+        // the three lists go through the ring when the driver can bind a buffer texture to a
+        // sub-range (GL 4.3 / ARB_texture_buffer_range); otherwise the setter is ignored
+        void setStreamBuffer(StreamBuffer* stream);
+
+        void build(const glm::mat4& view, const std::vector<PointLight>& lights);
+        // own buffers: orphan + refill; with a ring: nothing, commitFrame() uploads every frame
+        void upload();
+        // once per frame before the draws; no-op without a ring
+        void commitFrame();
+
+        // binds the three buffer textures on units firstUnit .. firstUnit + 2
+        void bind(int firstUnit);
+        // samplers + grid parameters for a program using the clustered lookup
+        void setUniforms(GLuint program, int firstUnit);
+
+        int getLightCount() const { return (int)lightCount; }
+        size_t getIndexCount() const { return lightIndices.size(); }
+        int getMaxLightsInCluster() const { return maxLightsInCluster; }
+        float getLastBuildMs() const { return lastBuildMs; }
+
+        // lights further than this (view depth) are not clustered
+        static constexpr float kClusterFar = 400.0f;
+        // slice 0 covers [zNear, kNearSliceZ], the rest is exponential up to kClusterFar
+        static constexpr float kNearSliceZ = 5.0f;
+        static constexpr int kMaxLightsPerCluster = 256;
+
+    private:
+        struct ClusterBounds {
+            glm::vec3 minP;
+            glm::vec3 maxP;
+        };
+
+        struct EyeLight {
+            glm::vec3 posEye;
+            float radius;
+            int sliceMin;
+            int sliceMax;
+        };
+
+        int tilesX = 0, tilesY = 0, slicesZ = 0;
+        glm::ivec2 tileSizePx = glm::ivec2(1);     // pixels, x and y
+        float zNear = 0.1f, zFar = 1000.0f;
+        float logScale = 1.0f;
+
+        std::vector<ClusterBounds> clusterBounds;   // view space, rebuilt by setProjection
+
+        // per-frame CPU data
+        std::vector<EyeLight> eyeLights;
+        std::vector<glm::vec4> lightData;           // 2 texels per light: (posEye, radius), (color, 0)
+        std::vector<GLuint> clusterCounts;          // scratch, kMaxLightsPerCluster per cluster
+        std::vector<GLuint> clusterScratch;
+        std::vector<GLuint> clusterGrid;            // 2 uints per cluster: offset, count
+        std::vector<GLuint> lightIndices;
+        size_t lightCount = 0;
+        int maxLightsInCluster = 0;
+        float lastBuildMs = 0.0f;
+        JobSystem* jobs = nullptr;
+        StreamBuffer* stream = nullptr;
+        GLint texelAlignment = 16;
+
+        GLuint lightBuffer = 0, lightTexture = 0;
+        GLuint gridBuffer = 0, gridTexture = 0;
+        GLuint indexBuffer = 0, indexTexture = 0;
+
+        int sliceOf(float viewZ) const;
+        float sliceStart(int slice) const;
+        void buildSlices(int sliceBegin, int sliceEnd);
+    };
+}
+
+#endif /* ClusteredLights_hpp */
@@ -0,0 +1,196 @@
+#include "CpuProfiler.hpp"
+
+#if defined(WT_PROFILING)
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gps {
+
+    namespace {
+
+        // One ring entry. The fields are atomics so the exporter can read an entry the owner is
+        // overwriting without a data race; the claimed index tells it to drop that entry.
+        struct Slot {
+            std::atomic<const char*> name{ nullptr };
+            std::atomic<uint64_t> startNs{ 0 };
+            std::atomic<uint64_t> durationNs{ 0 };
+            std::atomic<int> tid{ 0 };
+        };
+
+        // Single-producer ring: only the owning thread writes. An event is claimed before its
+        // slot is touched and published (written, release) once it is complete; the exporter
+        // copies the published range and then drops whatever was claimed again meanwhile.
+        struct ThreadBuffer {
+            static constexpr uint64_t kCapacity = 1u << 15;
+
+            std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(kCapacity);
+            std::atomic<uint64_t> claimed{ 0 };
+            std::atomic<uint64_t> written{ 0 };
+            bool inUse = false;   // guarded by registryMutex
+            int tid = 0;          // lane of the current owner, set under registryMutex on hand-out
+        };
+
+        std::mutex registryMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> registry;
+        std::vector<std::string> laneNames;   // by tid, guarded by registryMutex
+
+        // threads that end (the scene loader, the job pools of --bench-jobs) hand their buffer
+        // back on exit, so the next thread reuses it instead of growing the registry; it gets a
+        // lane of its own, the events of the previous owner keep theirs
+        struct ThreadSlot {
+            ThreadBuffer* buffer = nullptr;
+
+            ~ThreadSlot()
+            {
+                if (!buffer) return;
+                std::lock_guard<std::mutex> lock(registryMutex);
+                buffer->inUse = false;
+            }
+        };
+
+        thread_local ThreadSlot threadSlot;
+
+        // registryMutex held
+        int newLane()
+        {
+            int tid = (int)laneNames.size();
+            laneNames.push_back("thread " + std::to_string(tid));
+            return tid;
+        }
+
+        ThreadBuffer* acquireThreadBuffer()
+        {
+            if (threadSlot.buffer) return threadSlot.buffer;
+
+            std::lock_guard<std::mutex> lock(registryMutex);
+            ThreadBuffer* buffer = nullptr;
+            for (auto& candidate : registry) {
+                if (!candidate->inUse) {
+                    buffer = candidate.get();
+                    break;
+                }
+            }
+            if (!buffer) {
+                registry.push_back(std::make_unique<ThreadBuffer>());
+                buffer = registry.back().get();
+            }
+
+            buffer->inUse = true;
+            buffer->tid = newLane();
+            threadSlot.buffer = buffer;
+            return buffer;
+        }
+
+        void writeEscaped(std::ostream& out, const char* text)
+        {
+            for (const char* c = text; *c; c++) {
+                if (*c == '"' || *c == '\\') out << '\\';
+                out << *c;
+            }
+        }
+    }
+
+    uint64_t CpuProfiler::nowNs()
+    {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void CpuProfiler::record(const char* name, uint64_t startNs, uint64_t endNs)
+    {
+        ThreadBuffer* buffer = acquireThreadBuffer();
+
+        uint64_t index = buffer->written.load(std::memory_order_relaxed);
+        buffer->claimed.store(index + 1, std::memory_order_relaxed);
+
+        // release: whoever reads one of these values also sees the claim above
+        Slot& slot = buffer->slots[index % ThreadBuffer::kCapacity];
+        slot.name.store(name, std::memory_order_release);
+        slot.startNs.store(startNs, std::memory_order_release);
+        slot.durationNs.store(endNs - startNs, std::memory_order_release);
+        slot.tid.store(buffer->tid, std::memory_order_release);
+
+        buffer->written.store(index + 1, std::memory_order_release);
+    }
+
+    void CpuProfiler::setThreadName(const char* name)
+    {
+        ThreadBuffer* buffer = acquireThreadBuffer();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        laneNames[buffer->tid] = name;
+    }
+
+    bool CpuProfiler::exportChromeTrace(const std::string& path)
+    {
+        std::ofstream out(path);
+        if (!out) {
+            std::cout << "ERROR: could not write trace " << path << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        size_t eventCount = 0;
+
+        for (int tid = 0; tid < (int)laneNames.size(); tid++) {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":\"";
+            writeEscaped(out, laneNames[tid].c_str());
+            out << "\"}}";
+            first = false;
+        }
+
+        struct Copied {
+            CpuProfiler::Event event;
+            int tid;
+        };
+
+        for (const auto& buffer : registry) {
+            // only published events: the one being recorded right now is not part of the copy
+            uint64_t end = buffer->written.load(std::memory_order_acquire);
+            uint64_t begin = end > ThreadBuffer::kCapacity ? end - ThreadBuffer::kCapacity : 0;
+
+            std::vector<Copied> copy;
+            copy.reserve((size_t)(end - begin));
+            for (uint64_t i = begin; i < end; i++) {
+                const Slot& slot = buffer->slots[i % ThreadBuffer::kCapacity];
+                copy.push_back({ { slot.name.load(std::memory_order_acquire),
+                    slot.startNs.load(std::memory_order_acquire),
+                    slot.durationNs.load(std::memory_order_acquire) },
+                    slot.tid.load(std::memory_order_acquire) });
+            }
+
+            // events the owner claimed while we were copying may have replaced the oldest ones
+            uint64_t claimedAfter = buffer->claimed.load(std::memory_order_relaxed);
+            uint64_t firstValid = claimedAfter > ThreadBuffer::kCapacity ? claimedAfter - ThreadBuffer::kCapacity : 0;
+            size_t skip = firstValid > begin ? (size_t)(firstValid - begin) : 0;
+
+            for (size_t i = skip; i < copy.size(); i++) {
+                const CpuProfiler::Event& e = copy[i].event;
+                out << ",\n{\"name\":\"";
+                writeEscaped(out, e.name);
+                out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << copy[i].tid
+                    << ",\"ts\":" << (double)e.startNs / 1000.0
+                    << ",\"dur\":" << (double)e.durationNs / 1000.0 << "}";
+                eventCount++;
+            }
+        }
+
+        out << "\n]}\n";
+        std::cout << "[PROFILER] " << eventCount << " events -> " << path << std::endl;
+        return true;
+    }
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef CpuProfiler_hpp
+#define CpuProfiler_hpp
+
+// CPU zones for chrome://tracing / Perfetto.
+// Only compiled in when WT_PROFILING is defined (Debug configurations); otherwise every
+// WT_PROFILE_* macro expands to nothing and this header declares nothing.
+//
+//   WT_PROFILE_FUNCTION();           zone named after the enclosing function
+//   WT_PROFILE_SCOPE("name");        zone with a literal name (the pointer is stored, not copied)
+//   WT_PROFILE_THREAD("name");       lane name for the calling thread
+//   WT_PROFILE_EXPORT("trace.json"); writes the events still in the per-thread rings
+
+#if defined(WT_PROFILING)
+
+#include <cstdint>
+#include <string>
+
+namespace gps {
+
+    class CpuProfiler {
+
+    public:
+        struct Event {
+            const char* name;
+            uint64_t startNs;
+            uint64_t durationNs;
+        };
+
+        class Scope {
+        public:
+            explicit Scope(const char* name) : name(name), startNs(nowNs()) {}
+            ~Scope() { record(name, startNs, nowNs()); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            const char* name;
+            uint64_t startNs;
+        };
+
+        // nanoseconds since the first call (steady clock)
+        static uint64_t nowNs();
+
+        // appends to the calling thread's ring; lock-free after the thread's first event
+        static void record(const char* name, uint64_t startNs, uint64_t endNs);
+
+        static void setThreadName(const char* name);
+
+        static bool exportChromeTrace(const std::string& path);
+    };
+}
+
+#define WT_PROFILE_CONCAT_INNER(a, b) a##b
+#define WT_PROFILE_CONCAT(a, b) WT_PROFILE_CONCAT_INNER(a, b)
+
+#define WT_PROFILE_SCOPE(name) gps::CpuProfiler::Scope WT_PROFILE_CONCAT(wtProfileScope, __LINE__)(name)
+#define WT_PROFILE_FUNCTION() WT_PROFILE_SCOPE(__func__)
+#define WT_PROFILE_THREAD(name) gps::CpuProfiler::setThreadName(name)
+#define WT_PROFILE_EXPORT(path) gps::CpuProfiler::exportChromeTrace(path)
+
+#else
+
+#define WT_PROFILE_SCOPE(name)
+#define WT_PROFILE_FUNCTION()
+#define WT_PROFILE_THREAD(name)
+#define WT_PROFILE_EXPORT(path)
+
+#endif
+
+#endif /* CpuProfiler_hpp */
@@ -0,0 +1,319 @@
+#include "FrameCapture.hpp"
+#include "CpuProfiler.hpp"
+#include "Checksum.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace gps {
+
+    // ---- image writers (rows arrive bottom-up, files are top-down) ----
+
+    static void appendBigEndian(std::vector<unsigned char>& out, uint32_t v)
+    {
+        out.push_back((unsigned char)(v >> 24));
+        out.push_back((unsigned char)(v >> 16));
+        out.push_back((unsigned char)(v >> 8));
+        out.push_back((unsigned char)v);
+    }
+
+    static void writeChunk(std::ofstream& out, const char* type, const std::vector<unsigned char>& data)
+    {
+        std::vector<unsigned char> chunk;
+        appendBigEndian(chunk, (uint32_t)data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        // the CRC covers type + data, not the length
+        appendBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+        out.write((const char*)chunk.data(), chunk.size());
+    }
+
+    static void writePNG(std::ofstream& out, const std::vector<unsigned char>& rgba, int width, int height)
+    {
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        out.write((const char*)signature, sizeof(signature));
+
+        std::vector<unsigned char> header;
+        appendBigEndian(header, (uint32_t)width);
+        appendBigEndian(header, (uint32_t)height);
+        header.push_back(8);    // bit depth
+        header.push_back(2);    // RGB
+        header.push_back(0);    // deflate
+        header.push_back(0);    // adaptive filtering
+        header.push_back(0);    // no interlace
+        writeChunk(out, "IHDR", header);
+
+        // scanlines: filter byte (none) + RGB
+        size_t rowBytes = 1 + (size_t)width * 3;
+        std::vector<unsigned char> raw(rowBytes * height);
+        for (int y = 0; y < height; y++) {
+            const unsigned char* src = rgba.data() + (size_t)(height - 1 - y) * width * 4;
+            unsigned char* dst = raw.data() + (size_t)y * rowBytes;
+            *dst++ = 0;
+            for (int x = 0; x < width; x++, src += 4) {
+                *dst++ = src[0];
+                *dst++ = src[1];
+                *dst++ = src[2];
+            }
+        }
+
+        // zlib stream made of stored (uncompressed) deflate blocks
+        std::vector<unsigned char> idat;
+        idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+        idat.push_back(0x78);
+        idat.push_back(0x01);
+        uint32_t adler = 1;     // Adler-32 of nothing
+        for (size_t offset = 0;;) {
+            size_t len = std::min<size_t>(65535, raw.size() - offset);
+            bool last = offset + len >= raw.size();
+            idat.push_back(last ? 1 : 0);
+            idat.push_back((unsigned char)(len & 0xFF));
+            idat.push_back((unsigned char)(len >> 8));
+            idat.push_back((unsigned char)(~len & 0xFF));
+            idat.push_back((unsigned char)((~len >> 8) & 0xFF));
+            idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + len);
+
+            adler = adler32(raw.data() + offset, len, adler);
+            offset += len;
+            if (last) break;
+        }
+        appendBigEndian(idat, adler);
+        writeChunk(out, "IDAT", idat);
+
+        writeChunk(out, "IEND", std::vector<unsigned char>());
+    }
+
+    static void writePPM(std::ofstream& out, const std::vector<unsigned char>& rgba, int width, int height)
+    {
+        out << "P6\n" << width << " " << height << "\n255\n";
+
+        std::vector<unsigned char> row((size_t)width * 3);
+        for (int y = height - 1; y >= 0; y--) {
+            const unsigned char* src = rgba.data() + (size_t)y * width * 4;
+            for (int x = 0; x < width; x++) {
+                row[x * 3 + 0] = src[x * 4 + 0];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + 2];
+            }
+            out.write((const char*)row.data(), row.size());
+        }
+    }
+
+    // ---- FrameCapture ----
+
+    FrameCapture::~FrameCapture()
+    {
+        release();
+    }
+
+    bool FrameCapture::init(int width, int height, int encoderThreads)
+    {
+        release();
+        if (width <= 0 || height <= 0) return false;
+
+        this->width = width;
+        this->height = height;
+
+        glGenRenderbuffers(1, &colorRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+        glGenRenderbuffers(1, &depthRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "FrameCapture: framebuffer incomplete (0x" << std::hex << status << std::dec << ")" << std::endl;
+            release();
+            return false;
+        }
+
+        GLsizeiptr bytes = (GLsizeiptr)width * height * 4;
+        for (Readback& r : readbacks) {
+            glGenBuffers(1, &r.pbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, r.pbo);
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        stopping = false;
+        for (int i = 0; i < std::max(1, encoderThreads); i++)
+            encoders.emplace_back(&FrameCapture::encoderLoop, this);
+
+        return true;
+    }
+
+    void FrameCapture::capture(const std::string& path, ImageFormat format)
+    {
+        WT_PROFILE_FUNCTION();
+
+        // the slot is reused: its previous read (kPboCount captures ago) is finished by now
+        Readback& r = readbacks[nextReadback];
+        if (r.pending) collect(r);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+        // PBO bound: glReadPixels returns immediately, the copy runs on the GPU timeline
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, r.pbo);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        r.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        r.path = path;
+        r.format = format;
+        r.pending = true;
+
+        nextReadback = (nextReadback + 1) % kPboCount;
+    }
+
+    void FrameCapture::collect(Readback& r)
+    {
+        WT_PROFILE_FUNCTION();
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        // normally already signalled; the flush bit avoids waiting on commands never submitted
+        while (glClientWaitSync(r.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(r.fence);
+        r.fence = nullptr;
+        r.pending = false;
+
+        EncodeJob job;
+        job.path = r.path;
+        job.format = r.format;
+        {
+            // backpressure: never queue more than kMaxQueuedImages frames in RAM
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueChanged.wait(lock, [this]() { return queue.size() < kMaxQueuedImages; });
+            if (!freePixels.empty()) {
+                job.pixels = std::move(freePixels.back());
+                freePixels.pop_back();
+            }
+        }
+
+        stallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        size_t bytes = (size_t)width * height * 4;
+        job.pixels.resize(bytes);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, r.pbo);
+        const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_READ_BIT);
+        if (mapped) {
+            std::memcpy(job.pixels.data(), mapped, bytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        if (!mapped) {
+            std::cerr << "FrameCapture: could not map readback buffer for " << job.path << std::endl;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(job));
+        }
+        queueChanged.notify_all();
+    }
+
+    void FrameCapture::finish()
+    {
+        WT_PROFILE_FUNCTION();
+
+        // oldest first, so the files are queued in capture order
+        for (int i = 0; i < kPboCount; i++) {
+            Readback& r = readbacks[(nextReadback + i) % kPboCount];
+            if (r.pending) collect(r);
+        }
+
+        std::unique_lock<std::mutex> lock(queueMutex);
+        queueChanged.wait(lock, [this]() { return queue.empty() && encoding == 0; });
+    }
+
+    size_t FrameCapture::getFramesWritten() const
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        return framesWritten;
+    }
+
+    void FrameCapture::encoderLoop()
+    {
+        WT_PROFILE_THREAD("frame encoder");
+
+        for (;;) {
+            EncodeJob job;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+
+                job = std::move(queue.front());
+                queue.pop_front();
+                encoding++;
+            }
+            queueChanged.notify_all();
+
+            writeImage(job);
+
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                encoding--;
+                framesWritten++;
+                freePixels.push_back(std::move(job.pixels));
+            }
+            queueChanged.notify_all();
+        }
+    }
+
+    void FrameCapture::writeImage(const EncodeJob& job) const
+    {
+        WT_PROFILE_SCOPE("FrameCapture::writeImage");
+
+        std::ofstream out(job.path, std::ios::binary);
+        if (!out) {
+            std::cerr << "FrameCapture: cannot write " << job.path << std::endl;
+            return;
+        }
+
+        if (job.format == FORMAT_PNG) writePNG(out, job.pixels, width, height);
+        else writePPM(out, job.pixels, width, height);
+    }
+
+    void FrameCapture::release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueChanged.notify_all();
+        for (auto& t : encoders) t.join();
+        encoders.clear();
+        queue.clear();
+
+        for (Readback& r : readbacks) {
+            if (r.fence) glDeleteSync(r.fence);
+            if (r.pbo) glDeleteBuffers(1, &r.pbo);
+            r = Readback();
+        }
+        nextReadback = 0;
+
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (colorRenderbuffer) glDeleteRenderbuffers(1, &colorRenderbuffer);
+        if (depthRenderbuffer) glDeleteRenderbuffers(1, &depthRenderbuffer);
+        fbo = colorRenderbuffer = depthRenderbuffer = 0;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef FrameCapture_hpp
+#define FrameCapture_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gps {
+
+    // Offscreen render target (RGBA8 colour + DEPTH24) with asynchronous readback to disk.
+    // capture() only queues a glReadPixels into a pixel pack buffer and a fence; the PBO is
+    // mapped kPboCount captures later, when the copy has long finished, and the pixels are
+    // handed to encoder threads. GPU rendering, readback and PPM/PNG writing overlap.
+    class FrameCapture {
+
+    public:
+        enum ImageFormat {
+            FORMAT_PPM,
+            FORMAT_PNG      // uncompressed deflate: no encoder dependency, cheap to write
+        };
+
+        ~FrameCapture();
+
+        // creates the FBO + PBO ring and starts the encoder threads
+        bool init(int width, int height, int encoderThreads = 2);
+
+        GLuint getFramebuffer() const { return fbo; }
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        // reads what is currently in the target; the file is written a few frames later
+        void capture(const std::string& path, ImageFormat format);
+        // maps every pending PBO and waits for the encoders: all files are on disk on return
+        void finish();
+        // joins the encoders (they write out what is queued) and deletes the GL objects;
+        // call it while the context is still current, the destructor is too late for that
+        void release();
+
+        size_t getFramesWritten() const;
+        // time the render thread spent waiting (fences + full encoder queue)
+        double getStallMs() const { return stallMs; }
+
+        static constexpr int kPboCount = 3;
+        // encoder backlog limit (memory: kMaxQueuedImages * width * height * 4 bytes)
+        static constexpr size_t kMaxQueuedImages = 8;
+
+    private:
+        struct Readback {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+            std::string path;
+            ImageFormat format = FORMAT_PPM;
+            bool pending = false;
+        };
+
+        struct EncodeJob {
+            std::string path;
+            ImageFormat format;
+            std::vector<unsigned char> pixels;   // RGBA, bottom row first (GL order)
+        };
+
+        GLuint fbo = 0;
+        GLuint colorRenderbuffer = 0;
+        GLuint depthRenderbuffer = 0;
+        int width = 0;
+        int height = 0;
+
+        Readback readbacks[kPboCount];
+        int nextReadback = 0;
+
+        std::vector<std::thread> encoders;
+        mutable std::mutex queueMutex;
+        std::condition_variable queueChanged;
+        std::deque<EncodeJob> queue;
+        std::vector<std::vector<unsigned char>> freePixels;
+        size_t encoding = 0;
+        size_t framesWritten = 0;
+        bool stopping = false;
+
+        double stallMs = 0.0;
+
+        void collect(Readback& readback);
+        void encoderLoop();
+        void writeImage(const EncodeJob& job) const;
+    };
+}
+
+#endif /* FrameCapture_hpp */
@@ -0,0 +1,90 @@
+#include "GBuffer.hpp"
+
+#include <iostream>
+
+namespace gps {
+
+    static GLuint createTarget(GLint internalFormat, GLenum format, GLenum type, int width, int height)
+    {
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, NULL);
+
+        // read 1:1 with texelFetch, no filtering
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return tex;
+    }
+
+    GBuffer::~GBuffer()
+    {
+        destroyTargets();
+    }
+
+    void GBuffer::resize(int width, int height)
+    {
+        if (fbo && width == this->width && height == this->height) return;
+        if (width <= 0 || height <= 0) return;
+
+        destroyTargets();
+        this->width = width;
+        this->height = height;
+        createTargets();
+    }
+
+    void GBuffer::createTargets()
+    {
+        albedoTex = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+        normalTex = createTarget(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, width, height);
+        depthTex = createTarget(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, width, height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTex, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTex, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTex, 0);
+
+        const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR: G-buffer framebuffer incomplete" << std::endl;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void GBuffer::destroyTargets()
+    {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (albedoTex) glDeleteTextures(1, &albedoTex);
+        if (normalTex) glDeleteTextures(1, &normalTex);
+        if (depthTex) glDeleteTextures(1, &depthTex);
+        fbo = albedoTex = normalTex = depthTex = 0;
+    }
+
+    void GBuffer::bindForGeometryPass()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, width, height);
+
+        // albedo.a = 0 and depth = 1 mark pixels with no geometry
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void GBuffer::bindTextures(int firstUnit)
+    {
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 0);
+        glBindTexture(GL_TEXTURE_2D, albedoTex);
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 1);
+        glBindTexture(GL_TEXTURE_2D, normalTex);
+        glActiveTexture(GL_TEXTURE0 + firstUnit + 2);
+        glBindTexture(GL_TEXTURE_2D, depthTex);
+        glActiveTexture(GL_TEXTURE0);
+    }
+}
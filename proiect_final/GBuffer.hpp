@@ -0,0 +1,48 @@
+#ifndef GBuffer_hpp
+#define GBuffer_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+namespace gps {
+
+    // Render targets for the deferred path:
+    //   location 0 -> albedo (RGBA8)
+    //   location 1 -> eye-space normal (RGBA16F)
+    //   depth      -> DEPTH_COMPONENT24 (eye-space position is rebuilt from it)
+    class GBuffer {
+
+    public:
+        ~GBuffer();
+
+        // (re)creates the targets when the size changes; cheap no-op otherwise
+        void resize(int width, int height);
+
+        // binds the FBO and clears it (call before the geometry pass)
+        void bindForGeometryPass();
+        // albedo, normal, depth on units firstUnit .. firstUnit + 2
+        void bindTextures(int firstUnit);
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+    private:
+        GLuint fbo = 0;
+        GLuint albedoTex = 0;
+        GLuint normalTex = 0;
+        GLuint depthTex = 0;
+
+        int width = 0;
+        int height = 0;
+
+        void createTargets();
+        void destroyTargets();
+    };
+}
+
+#endif /* GBuffer_hpp */
@@ -0,0 +1,155 @@
+#include "GpuProfiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace gps {
+
+    static const double kSmoothing = 0.1;
+
+    GpuProfiler::Scope::Scope(GpuProfiler& profiler, const char* name)
+        : profiler(profiler), pass(profiler.beginPass(name))
+    {
+    }
+
+    GpuProfiler::Scope::~Scope()
+    {
+        profiler.endPass(pass);
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+        release();
+    }
+
+    void GpuProfiler::release()
+    {
+        for (auto& slot : slots) {
+            if (!slot.queries.empty()) glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+            slot = FrameSlot();
+        }
+
+        // the query ids of a pass are gone with the slots
+        passes.clear();
+        frameIndex = 0;
+        currentSlot = 0;
+    }
+
+    int GpuProfiler::registerPass(const char* name)
+    {
+        for (int i = 0; i < (int)passes.size(); i++) {
+            if (std::strcmp(passes[i].name.c_str(), name) == 0) return i;
+        }
+
+        PassTiming timing;
+        timing.name = name;
+        passes.push_back(timing);
+
+        for (auto& slot : slots) {
+            GLuint ids[2];
+            glGenQueries(2, ids);
+            slot.queries.push_back(ids[0]);
+            slot.queries.push_back(ids[1]);
+            slot.issued.push_back(0);
+        }
+        return (int)passes.size() - 1;
+    }
+
+    void GpuProfiler::beginFrame()
+    {
+        if (!enabled) return;
+
+        currentSlot = (int)(frameIndex % kFrameLatency);
+        FrameSlot& slot = slots[currentSlot];
+
+        // this slot was last written kFrameLatency frames ago
+        if (frameIndex >= (unsigned long long)kFrameLatency) collect(slot);
+        std::fill(slot.issued.begin(), slot.issued.end(), 0);
+    }
+
+    void GpuProfiler::endFrame()
+    {
+        if (!enabled) return;
+        frameIndex++;
+    }
+
+    int GpuProfiler::beginPass(const char* name)
+    {
+        if (!enabled) return -1;
+
+        int pass = registerPass(name);
+        glQueryCounter(slots[currentSlot].queries[2 * pass + 0], GL_TIMESTAMP);
+        return pass;
+    }
+
+    void GpuProfiler::endPass(int pass)
+    {
+        if (pass < 0 || !enabled) return;
+
+        FrameSlot& slot = slots[currentSlot];
+        glQueryCounter(slot.queries[2 * pass + 1], GL_TIMESTAMP);
+        slot.issued[pass] = 1;
+    }
+
+    void GpuProfiler::collect(FrameSlot& slot)
+    {
+        for (int i = 0; i < (int)slot.issued.size(); i++) {
+            if (!slot.issued[i]) continue;
+
+            // normally ready long ago; if the GPU is that far behind, drop the sample instead of stalling
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[2 * i + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(slot.queries[2 * i + 0], GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(slot.queries[2 * i + 1], GL_QUERY_RESULT, &t1);
+
+            PassTiming& timing = passes[i];
+            timing.lastMs = (double)(t1 - t0) / 1.0e6;
+            timing.smoothedMs = timing.samples ? timing.smoothedMs + (timing.lastMs - timing.smoothedMs) * kSmoothing : timing.lastMs;
+            timing.totalMs += timing.lastMs;
+            timing.samples++;
+        }
+    }
+
+    void GpuProfiler::resetStats()
+    {
+        for (auto& timing : passes) {
+            timing.totalMs = 0.0;
+            timing.samples = 0;
+        }
+    }
+
+    std::string GpuProfiler::formatSummary() const
+    {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2);
+        for (size_t i = 0; i < passes.size(); i++) {
+            if (i > 0) out << " | ";
+            out << passes[i].name << " " << passes[i].smoothedMs;
+        }
+        out << " ms";
+        return out.str();
+    }
+
+    void GpuProfiler::writeCSV(std::ostream& out) const
+    {
+        out << "pass,last_ms,avg_ms,samples\n";
+        for (const auto& timing : passes) {
+            out << timing.name << "," << timing.lastMs << "," << timing.averageMs() << "," << timing.samples << "\n";
+        }
+    }
+
+    void GpuProfiler::writeJSON(std::ostream& out) const
+    {
+        out << "{ ";
+        for (size_t i = 0; i < passes.size(); i++) {
+            if (i > 0) out << ", ";
+            out << "\"" << passes[i].name << "\": " << passes[i].averageMs();
+        }
+        out << " }";
+    }
+}
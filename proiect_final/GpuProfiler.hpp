@@ -0,0 +1,93 @@
+#ifndef GpuProfiler_hpp
+#define GpuProfiler_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace gps {
+
+    // GPU time per render pass from GL_TIMESTAMP query pairs.
+    // Queries live in a ring of kFrameLatency frames: the results of frame N are read while
+    // frame N + kFrameLatency is being recorded, so reading never waits for the GPU.
+    // Passes register themselves by name the first time a Scope with that name runs.
+    class GpuProfiler {
+
+    public:
+        static constexpr int kFrameLatency = 4;
+
+        struct PassTiming {
+            std::string name;
+            double lastMs = 0.0;
+            double smoothedMs = 0.0;     // exponential moving average (display)
+            double totalMs = 0.0;        // since the last resetStats() (export)
+            unsigned long long samples = 0;
+
+            double averageMs() const { return samples ? totalMs / (double)samples : 0.0; }
+        };
+
+        // RAII timer around one pass; no-op while the profiler is disabled
+        class Scope {
+        public:
+            Scope(GpuProfiler& profiler, const char* name);
+            ~Scope();
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            GpuProfiler& profiler;
+            int pass;
+        };
+
+        ~GpuProfiler();
+
+        // deletes the queries and forgets the passes; needs the context, so call it before the
+        // window is destroyed (the destructor of a global runs too late)
+        void release();
+
+        void setEnabled(bool enabled) { this->enabled = enabled; }
+        bool isEnabled() const { return enabled; }
+
+        // bracket every frame; beginFrame also collects the frame that left the ring
+        void beginFrame();
+        void endFrame();
+
+        int beginPass(const char* name);
+        void endPass(int pass);
+
+        const std::vector<PassTiming>& getTimings() const { return passes; }
+        void resetStats();
+
+        // "shadow 0.41 | forward 2.10 | ..." (smoothed ms)
+        std::string formatSummary() const;
+        // name,last_ms,avg_ms,samples
+        void writeCSV(std::ostream& out) const;
+        // { "shadow": avg_ms, ... }
+        void writeJSON(std::ostream& out) const;
+
+    private:
+        struct FrameSlot {
+            std::vector<GLuint> queries;   // begin / end timestamp per pass
+            std::vector<char> issued;
+        };
+
+        bool enabled = true;
+        std::vector<PassTiming> passes;
+        FrameSlot slots[kFrameLatency];
+        unsigned long long frameIndex = 0;
+        int currentSlot = 0;
+
+        int registerPass(const char* name);
+        void collect(FrameSlot& slot);
+    };
+}
+
+#endif /* GpuProfiler_hpp */
@@ -0,0 +1,267 @@
+#include "ImpostorAtlas.hpp"
+#include "RenderStats.hpp"
+#include "StreamBuffer.hpp"
+#include "CpuProfiler.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+namespace gps {
+
+    // Frame (i, j) looks at the cluster from the hemi-octahedral grid point
+    // (u, v) = (i, j) / (kFramesPerSide - 1) * 2 - 1; the corners and edges of the grid are the
+    // horizon, its centre is straight up. Must match hemiOctEncode / frameBasis in impostor.vert/.frag.
+    static glm::vec3 frameDirection(int i, int j)
+    {
+        float u = (float)i / (float)(ImpostorAtlas::kFramesPerSide - 1) * 2.0f - 1.0f;
+        float v = (float)j / (float)(ImpostorAtlas::kFramesPerSide - 1) * 2.0f - 1.0f;
+
+        float x = 0.5f * (u + v);
+        float z = 0.5f * (u - v);
+        float y = 1.0f - std::fabs(x) - std::fabs(z);
+        return glm::normalize(glm::vec3(x, y, z));
+    }
+
+    static GLuint createAtlasArray(int side, int layers)
+    {
+        GLuint tex;
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, tex);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, side, side, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, ImpostorAtlas::kMaxMipLevel);
+        return tex;
+    }
+
+    ImpostorAtlas::~ImpostorAtlas()
+    {
+        release();
+    }
+
+    void ImpostorAtlas::release()
+    {
+        if (albedoArray) glDeleteTextures(1, &albedoArray);
+        if (normalDepthArray) glDeleteTextures(1, &normalDepthArray);
+        if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
+        if (VAO) glDeleteVertexArrays(1, &VAO);
+        albedoArray = normalDepthArray = instanceVBO = VAO = 0;
+        streamedLastDraw = false;
+
+        spheres.clear();
+        instances.clear();
+    }
+
+    void ImpostorAtlas::createTargets(int layers)
+    {
+        const int side = kFramesPerSide * kFrameSize;
+        albedoArray = createAtlasArray(side, layers);
+        normalDepthArray = createAtlasArray(side, layers);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        // quad corners come from gl_VertexID; one Instance per cluster
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &instanceVBO);
+
+        glBindVertexArray(VAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribDivisor(0, 1);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(0);
+
+        pointInstanceAttribs(instanceVBO, 0);
+    }
+
+    // the instance attributes read from buffer at offset (own VBO, or this frame's ring range)
+    void ImpostorAtlas::pointInstanceAttribs(GLuint buffer, GLintptr offset)
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*)(offset + offsetof(Instance, sphere)));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (GLvoid*)(offset + offsetof(Instance, layer)));
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void ImpostorAtlas::bake(Model3D& model, gps::Shader bakeShader)
+    {
+        WT_PROFILE_FUNCTION();
+
+        release();
+
+        const std::vector<Model3D::MeshCluster>& clusters = model.getClusters();
+        fades.assign(clusters.size(), 0.0f);
+        if (clusters.empty()) return;
+
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        int layers = std::min((int)clusters.size(), (int)maxLayers);
+        createTargets(layers);
+
+        // restored at the end (headless runs render into an offscreen target)
+        GLint previousFramebuffer = 0;
+        GLint previousViewport[4];
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+        const int side = kFramesPerSide * kFrameSize;
+
+        GLuint fbo, depthRenderbuffer;
+        glGenRenderbuffers(1, &depthRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, side, side);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+
+        const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, drawBuffers);
+
+        bakeShader.useShaderProgram();
+        GLint viewProjectionLoc = glGetUniformLocation(bakeShader.shaderProgram, "bakeViewProjection");
+
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);     // zero = no coverage, see the class comment
+
+        for (int c = 0; c < layers; c++) {
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, albedoArray, 0, c);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, normalDepthArray, 0, c);
+
+            if (c == 0 && glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                std::cout << "ERROR: impostor framebuffer incomplete" << std::endl;
+                break;
+            }
+
+            glViewport(0, 0, side, side);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            const Model3D::MeshCluster& cluster = clusters[c];
+            glm::vec3 center = 0.5f * (cluster.boundsMin + cluster.boundsMax);
+            float radius = std::max(0.5f * glm::length(cluster.boundsMax - cluster.boundsMin), 1e-3f);
+            spheres.push_back(glm::vec4(center, radius));
+
+            for (int j = 0; j < kFramesPerSide; j++) {
+                for (int i = 0; i < kFramesPerSide; i++) {
+                    glViewport(i * kFrameSize, j * kFrameSize, kFrameSize, kFrameSize);
+
+                    // orthographic, looking at the centre from dir; depth 0..1 spans the sphere
+                    glm::vec3 dir = frameDirection(i, j);
+                    glm::vec3 right = glm::normalize(glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), dir));
+                    glm::vec3 up = glm::cross(dir, right);
+
+                    glm::mat4 view = glm::lookAt(center + dir * radius, center, up);
+                    glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.0f, 2.0f * radius);
+                    glm::mat4 viewProjection = projection * view;
+                    glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, glm::value_ptr(viewProjection));
+
+                    model.DrawCluster(c, bakeShader);
+                }
+            }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &depthRenderbuffer);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, albedoArray);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, normalDepthArray);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        // two RGBA8 arrays + mip chain (~1/3)
+        size_t bytes = (size_t)side * side * 4 * 2 * spheres.size() * 4 / 3;
+        std::cout << "Impostors: " << spheres.size() << "/" << clusters.size() << " clusters baked, "
+            << kFramesPerSide << "x" << kFramesPerSide << " frames of " << kFrameSize << " px, "
+            << bytes / (1024 * 1024) << " MB" << std::endl;
+    }
+
+    void ImpostorAtlas::select(const glm::vec3& eyeLocal, float pixelsPerUnit, float maxPx, float maxDistance)
+    {
+        this->eyeLocal = eyeLocal;
+        std::fill(fades.begin(), fades.end(), 0.0f);
+        instances.clear();
+        instancesDirty = true;
+
+        if (maxPx <= 0.0f) return;
+
+        float fadeStartPx = maxPx * (1.0f + kFadeBand);
+        for (size_t c = 0; c < spheres.size(); c++) {
+            const glm::vec4& sphere = spheres[c];
+            float distance = glm::length(glm::vec3(sphere) - eyeLocal);
+            if (distance <= sphere.w) continue;    // inside the bounding sphere
+            if (maxDistance > 0.0f && distance - sphere.w > maxDistance) continue;
+
+            float diameterPx = 2.0f * sphere.w * pixelsPerUnit / distance;
+            float fade = std::min(std::max((fadeStartPx - diameterPx) / (fadeStartPx - maxPx), 0.0f), 1.0f);
+            if (fade <= 0.0f) continue;
+
+            fades[c] = fade;
+            instances.push_back({ sphere, (float)c, fade });
+        }
+    }
+
+    void ImpostorAtlas::Draw(gps::Shader shader)
+    {
+        if (instances.empty()) return;
+
+        // a few dozen bytes per cluster: through the ring every draw (an allocation lives one frame),
+        // otherwise re-specified only after select()
+        GLsizeiptr bytes = (GLsizeiptr)(instances.size() * sizeof(Instance));
+        StreamBuffer::Allocation allocation;
+        if (stream) allocation = stream->upload(instances.data(), bytes, sizeof(float));
+
+        if (allocation.isValid()) {
+            pointInstanceAttribs(stream->getBuffer(), allocation.offset);
+            streamedLastDraw = true;
+        }
+        else {
+            if (streamedLastDraw) {
+                pointInstanceAttribs(instanceVBO, 0);
+                streamedLastDraw = false;
+                instancesDirty = true;
+            }
+            if (instancesDirty) {
+                glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+                glBufferData(GL_ARRAY_BUFFER, bytes, instances.data(), GL_STREAM_DRAW);
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+                instancesDirty = false;
+            }
+        }
+
+        shader.useShaderProgram();
+
+        GLint loc;
+        if ((loc = glGetUniformLocation(shader.shaderProgram, "eyeLocal")) != -1)
+            glUniform3f(loc, eyeLocal.x, eyeLocal.y, eyeLocal.z);
+        if ((loc = glGetUniformLocation(shader.shaderProgram, "impostorAlbedo")) != -1) glUniform1i(loc, 0);
+        if ((loc = glGetUniformLocation(shader.shaderProgram, "impostorNormalDepth")) != -1) glUniform1i(loc, 1);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, albedoArray);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, normalDepthArray);
+
+        glBindVertexArray(VAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instances.size());
+        renderStats.addDraw(6 * (GLsizei)instances.size());
+        glBindVertexArray(0);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    }
+}
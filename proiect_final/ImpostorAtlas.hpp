@@ -0,0 +1,94 @@
+#ifndef ImpostorAtlas_hpp
+#define ImpostorAtlas_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "Model3D.hpp"
+#include "Shader.hpp"
+
+#include <vector>
+
+namespace gps {
+
+    class StreamBuffer;
+
+    // Octahedral impostors for Model3D's mesh clusters.
+    // At load time every cluster is rendered (orthographic, MODEL-LOCAL) from kFramesPerSide^2
+    // directions spread over the upper hemisphere with a hemi-octahedral mapping, into one layer
+    // of two texture arrays:
+    //   albedo      RGBA8: colour, alpha = coverage
+    //   normalDepth RGBA8: MODEL-LOCAL normal (xyz * 0.5 + 0.5), depth along the frame's view axis
+    // Empty texels are all zero, so both arrays are effectively premultiplied by coverage and
+    // their mipmaps stay valid at the silhouette (the shader divides by albedo.a).
+    //
+    // At runtime a far cluster is one camera-facing quad (one instanced draw for all of them).
+    // impostor.frag blends the 4 frames nearest to the view direction, rebuilds the surface point
+    // from the stored depth and writes gl_FragDepth, so the quad is lit, shadowed, fogged and
+    // depth-tested like the geometry it replaces. The shadow pass keeps the real geometry.
+    class ImpostorAtlas {
+
+    public:
+        ~ImpostorAtlas();
+
+        // renders every cluster (or the first GL_MAX_ARRAY_TEXTURE_LAYERS) into the atlas;
+        // bakeShader: impostorBake.vert / .frag with the vertex format defines of the meshes
+        void bake(Model3D& model, gps::Shader bakeShader);
+
+        // null: the instances live in their own buffer, re-specified after select()
+        void setStreamBuffer(StreamBuffer* stream) { this->stream = stream; }
+
+        // Fade per cluster from the projected diameter of its bounding sphere: 0 above
+        // maxPx * (1 + kFadeBand), 1 (impostor only) under maxPx, cross-fade in between.
+        // pixelsPerUnit = viewportHeight / (2 tan(fovy / 2)); maxPx <= 0 disables impostors.
+        // Clusters entirely farther than maxDistance (MODEL-LOCAL, <= 0: no limit) are not drawn.
+        void select(const glm::vec3& eyeLocal, float pixelsPerUnit, float maxPx, float maxDistance);
+        const std::vector<float>& getFades() const { return fades; }
+        size_t getDrawCount() const { return instances.size(); }
+
+        // every cluster with fade > 0; the bound program is impostor.vert + impostor.frag
+        // (model / normalMatrix set by the caller, atlas samplers on units 0 and 1)
+        void Draw(gps::Shader shader);
+
+        static constexpr int kFramesPerSide = 8;
+        // an odd count puts a frame at the grid centre, looking straight down: its basis (bake
+        // here, FrameBasis in impostorFrames.glsl) crosses the direction with world up -> NaN
+        static_assert(kFramesPerSide % 2 == 0, "no impostor frame may look along the up axis");
+        static constexpr int kFrameSize = 64;           // texels per frame side
+        static constexpr int kMaxMipLevel = 3;          // coarsest frame is 8x8, no bleeding between frames
+        static constexpr float kFadeBand = 0.25f;
+
+    private:
+        struct Instance {
+            glm::vec4 sphere;       // MODEL-LOCAL centre + radius
+            float layer;
+            float fade;
+        };
+
+        GLuint albedoArray = 0;
+        GLuint normalDepthArray = 0;
+        GLuint VAO = 0;
+        GLuint instanceVBO = 0;
+
+        std::vector<glm::vec4> spheres;     // one per baked cluster
+        std::vector<float> fades;           // one per Model3D cluster (unbaked ones stay 0)
+        std::vector<Instance> instances;
+        bool instancesDirty = false;
+        StreamBuffer* stream = nullptr;
+        bool streamedLastDraw = false;      // the VAO points into the ring
+        glm::vec3 eyeLocal = glm::vec3(0.0f);
+
+        void createTargets(int layers);
+        void pointInstanceAttribs(GLuint buffer, GLintptr offset);
+        void release();
+    };
+}
+
+#endif /* ImpostorAtlas_hpp */
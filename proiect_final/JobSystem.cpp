@@ -0,0 +1,227 @@
+#include "JobSystem.hpp"
+#include "CpuProfiler.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace gps {
+
+    // which JobSystem (if any) owns the calling thread, and its queue there
+    static thread_local const JobSystem* tlsOwner = nullptr;
+    static thread_local int tlsQueueIndex = -1;
+
+    JobSystem::JobSystem(int workerCount)
+    {
+        if (workerCount < 0) workerCount = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+
+        for (int i = 0; i < workerCount + 1; i++) queues.push_back(std::make_unique<WorkQueue>());
+
+        workers.reserve(workerCount);
+        for (int i = 0; i < workerCount; i++) workers.emplace_back(&JobSystem::workerMain, this, i);
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+
+        for (auto& worker : workers) worker.join();
+    }
+
+    int JobSystem::currentQueue() const
+    {
+        return tlsOwner == this ? tlsQueueIndex : (int)queues.size() - 1;
+    }
+
+    void JobSystem::push(QueuedJob queued)
+    {
+        {
+            WorkQueue& queue = *queues[currentQueue()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(queued));
+        }
+        queuedJobs.fetch_add(1, std::memory_order_release);
+
+        // taking the lock orders the increment against a worker that is about to sleep
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wakeUp.notify_one();
+    }
+
+    bool JobSystem::popOrSteal(int queueIndex, QueuedJob& out)
+    {
+        if (queuedJobs.load(std::memory_order_acquire) == 0) return false;
+
+        // own queue: newest first
+        {
+            WorkQueue& queue = *queues[queueIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.jobs.empty()) {
+                out = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // the others: oldest first
+        int queueCount = (int)queues.size();
+        for (int k = 1; k < queueCount; k++) {
+            WorkQueue& victim = *queues[(queueIndex + k) % queueCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                out = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void JobSystem::execute(QueuedJob& queued)
+    {
+        queued.job();
+        queued.job = nullptr;   // captured state dies before the counter releases the waiter
+        finish(queued.counter);
+    }
+
+    void JobSystem::finish(JobCounter* counter)
+    {
+        if (!counter) return;
+
+        // the last decrement and the hand-off of the continuations happen under the lock,
+        // which wait() takes before returning: the counter may be destroyed right after
+        std::vector<Job> ready;
+        {
+            std::lock_guard<std::mutex> lock(counter->continuationMutex);
+            if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            ready.swap(counter->continuations);
+        }
+        // the continuations were counted (on their own counters) by runAfter
+        for (auto& job : ready) push({ std::move(job), nullptr });
+    }
+
+    void JobSystem::run(Job job, JobCounter* counter)
+    {
+        if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+        push({ std::move(job), counter });
+    }
+
+    void JobSystem::runBackground(Job job, JobCounter* counter)
+    {
+        if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+        // no worker to take it: run it now rather than never
+        if (workers.empty()) {
+            QueuedJob queued{ std::move(job), counter };
+            execute(queued);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(backgroundQueue.mutex);
+            backgroundQueue.jobs.push_back({ std::move(job), counter });
+        }
+        queuedJobs.fetch_add(1, std::memory_order_release);
+
+        { std::lock_guard<std::mutex> lock(sleepMutex); }
+        wakeUp.notify_one();
+    }
+
+    bool JobSystem::popBackground(QueuedJob& out)
+    {
+        std::lock_guard<std::mutex> lock(backgroundQueue.mutex);
+        if (backgroundQueue.jobs.empty()) return false;
+
+        out = std::move(backgroundQueue.jobs.front());
+        backgroundQueue.jobs.pop_front();
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void JobSystem::runAfter(JobCounter& dependency, Job job, JobCounter* counter)
+    {
+        if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+        // the continuation finishes through a wrapper, so counter is released after it ran
+        Job wrapped = [this, job = std::move(job), counter]() {
+            job();
+            finish(counter);
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.continuationMutex);
+            if (!dependency.isDone()) {
+                dependency.continuations.push_back(std::move(wrapped));
+                return;
+            }
+        }
+        push({ std::move(wrapped), nullptr });
+    }
+
+    void JobSystem::wait(JobCounter& counter)
+    {
+        WT_PROFILE_FUNCTION();
+
+        int queueIndex = currentQueue();
+        QueuedJob queued;
+        while (!counter.isDone()) {
+            if (popOrSteal(queueIndex, queued)) execute(queued);
+            else std::this_thread::yield();
+        }
+
+        // the finishing thread may still hold it
+        std::lock_guard<std::mutex> lock(counter.continuationMutex);
+    }
+
+    void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body)
+    {
+        if (count == 0) return;
+
+        // a few chunks per thread so stealing can even out uneven ranges
+        size_t maxChunks = (size_t)getConcurrency() * 4;
+        size_t chunks = std::min((count + std::max<size_t>(grainSize, 1) - 1) / std::max<size_t>(grainSize, 1), maxChunks);
+        if (chunks <= 1 || workers.empty()) {
+            body(0, count);
+            return;
+        }
+
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        JobCounter counter;
+        for (size_t begin = chunkSize; begin < count; begin += chunkSize) {
+            size_t end = std::min(count, begin + chunkSize);
+            run([&body, begin, end]() { body(begin, end); }, &counter);
+        }
+
+        // the first chunk on the calling thread, then help with the rest
+        body(0, std::min(count, chunkSize));
+        wait(counter);
+    }
+
+    void JobSystem::workerMain(int index)
+    {
+        tlsOwner = this;
+        tlsQueueIndex = index;
+
+#if defined(WT_PROFILING)
+        // the profiler keeps its own copy of the lane name
+        std::string laneName = "job worker " + std::to_string(index);
+        WT_PROFILE_THREAD(laneName.c_str());
+#endif
+
+        QueuedJob queued;
+        while (true) {
+            if (popOrSteal(index, queued) || popBackground(queued)) {
+                execute(queued);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this]() { return stopping || queuedJobs.load(std::memory_order_acquire) > 0; });
+            if (stopping) return;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef JobSystem_hpp
+#define JobSystem_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gps {
+
+    typedef std::function<void()> Job;
+
+    // Counts the unfinished jobs of a batch; jobs registered with JobSystem::runAfter start once it
+    // reaches zero. A counter may be reused or destroyed only after wait() on it has returned.
+    class JobCounter {
+
+    public:
+        bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int> pending{ 0 };
+        std::mutex continuationMutex;
+        std::vector<Job> continuations;
+    };
+
+    // Work-stealing job scheduler.
+    // Every worker owns a deque: it pushes and pops its own jobs at the back (newest first, cache-warm)
+    // while idle workers steal from the front of the others (oldest first, usually the biggest chunks).
+    // Threads outside the pool (main, render) submit into one shared deque and, in wait(), run jobs
+    // themselves instead of blocking, so a JobSystem with 0 workers degrades to serial execution.
+    class JobSystem {
+
+    public:
+        // workerCount < 0: one worker per hardware thread, minus the calling thread
+        explicit JobSystem(int workerCount = -1);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // counter (optional) is incremented now and decremented when the job has run
+        void run(Job job, JobCounter* counter = nullptr);
+        // job starts only after every job counted by dependency has finished
+        void runAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+        // long, latency-insensitive work (file decoding): taken by idle workers only, never by wait(),
+        // so a frame waiting on its parallelFor does not pick it up
+        void runBackground(Job job, JobCounter* counter = nullptr);
+
+        // runs queued jobs on the calling thread until counter reaches zero
+        void wait(JobCounter& counter);
+
+        // body(begin, end) over [0, count) in chunks of at least grainSize; returns when all chunks ran
+        void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& body);
+
+        int getWorkerCount() const { return (int)workers.size(); }
+        // workers + the thread calling wait()
+        int getConcurrency() const { return (int)workers.size() + 1; }
+
+    private:
+        struct QueuedJob {
+            Job job;
+            JobCounter* counter;
+        };
+
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<QueuedJob> jobs;
+        };
+
+        // queues[0 .. workers-1] belong to the workers, the last one is shared by outside threads
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        WorkQueue backgroundQueue;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable wakeUp;
+        std::atomic<int> queuedJobs{ 0 };
+        std::atomic<bool> stopping{ false };
+
+        void push(QueuedJob queued);
+        bool popOrSteal(int queueIndex, QueuedJob& out);
+        bool popBackground(QueuedJob& out);
+        void execute(QueuedJob& queued);
+        void finish(JobCounter* counter);
+        void workerMain(int index);
+        int currentQueue() const;
+    };
+}
+
+#endif /* JobSystem_hpp */
@@ -1,24 +1,70 @@
 #include "Mesh.hpp"
+#include "RenderStats.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 namespace gps {
 
     Mesh::Mesh(std::vector<Vertex> vertices,
         std::vector<GLuint> indices,
         std::vector<Texture> textures,
-        glm::vec3 kdColor)
+        glm::vec3 kdColor,
+        VertexFormat format,
+        std::vector<MeshLod> lods,
+        std::vector<glm::mat4> instances)
     {
         this->vertices = std::move(vertices);
         this->indices = std::move(indices);
         this->textures = std::move(textures);
         this->kdColor = kdColor;
+        this->format = format;
+
+        this->lods = std::move(lods);
+        if (this->lods.empty())
+            this->lods.push_back({ 0, (GLsizei)this->indices.size(), 0.0f });
+
+        this->instances = std::move(instances);
 
         this->setupMesh();
     }
 
-    Buffers Mesh::getBuffers() {
+    Buffers Mesh::getBuffers() const {
         return this->buffers;
     }
 
+    size_t Mesh::getVertexBytes() const
+    {
+        return vertices.size() * (format == VERTEX_PACKED ? sizeof(PackedVertex) : sizeof(Vertex));
+    }
+
+    size_t Mesh::getIndexBytes() const
+    {
+        return indices.size() * (indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+    }
+
+    void Mesh::selectLod(int lod)
+    {
+        selectedLod = std::min(std::max(lod, 0), (int)lods.size() - 1);
+    }
+
+    size_t Mesh::getIndexOffset(const MeshLod& lod) const
+    {
+        return (size_t)lod.firstIndex * (indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint));
+    }
+
+    void Mesh::setDequantizeUniforms(GLuint program) const
+    {
+        if (format != VERTEX_PACKED) return;
+
+        GLint loc;
+        if ((loc = glGetUniformLocation(program, "posScale")) != -1) glUniform3f(loc, posScale.x, posScale.y, posScale.z);
+        if ((loc = glGetUniformLocation(program, "posOffset")) != -1) glUniform3f(loc, posOffset.x, posOffset.y, posOffset.z);
+    }
+
     void Mesh::Draw(gps::Shader shader)
     {
         shader.useShaderProgram();
@@ -55,15 +101,27 @@ namespace gps {
             glUniform1i(diffuseSamplerLoc, 0); // we bind diffuse on unit 0
         }
 
+        setDequantizeUniforms(shader.shaderProgram);
+
         // bind diffuseTexture only (shader uses only one sampler)
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, hasDiffuse ? diffuseTexId : 0);
 
         // draw
         glBindVertexArray(this->buffers.VAO);
-        glDrawElements(GL_TRIANGLES, (GLsizei)this->indices.size(), GL_UNSIGNED_INT, 0);
+        const MeshLod& lod = lods[selectedLod];
+        if (isInstanced()) {
+            glDrawElementsInstanced(GL_TRIANGLES, lod.indexCount, indexType, (GLvoid*)getIndexOffset(lod), getInstanceCount());
+            renderStats.addDraw(lod.indexCount * getInstanceCount());
+        }
+        else {
+            glDrawElements(GL_TRIANGLES, lod.indexCount, indexType, (GLvoid*)getIndexOffset(lod));
+            renderStats.addDraw(lod.indexCount);
+        }
         glBindVertexArray(0);
 
+        if (isInstanced()) setDefaultInstanceMatrix();
+
         // cleanup
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -77,18 +135,39 @@ namespace gps {
 
         glBindVertexArray(this->buffers.VAO);
 
+        // half the index memory / bandwidth whenever the vertex count allows it
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers.EBO);
+        if (this->vertices.size() <= kMaxShortIndexVertices) {
+            std::vector<GLushort> shortIndices(this->indices.begin(), this->indices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                shortIndices.size() * sizeof(GLushort),
+                shortIndices.data(),
+                GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_SHORT;
+        }
+        else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                this->indices.size() * sizeof(GLuint),
+                this->indices.data(),
+                GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_INT;
+        }
+
+        if (isInstanced()) uploadInstances();
+
         glBindBuffer(GL_ARRAY_BUFFER, this->buffers.VBO);
+
+        if (format == VERTEX_PACKED) {
+            uploadPacked();
+            glBindVertexArray(0);
+            return;
+        }
+
         glBufferData(GL_ARRAY_BUFFER,
             this->vertices.size() * sizeof(Vertex),
             this->vertices.data(),
             GL_STATIC_DRAW);
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->buffers.EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            this->indices.size() * sizeof(GLuint),
-            this->indices.data(),
-            GL_STATIC_DRAW);
-
         // layout(location=0) position
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid*)0);
@@ -105,4 +184,103 @@ namespace gps {
 
         glBindVertexArray(0);
     }
+
+    void Mesh::setDefaultInstanceMatrix()
+    {
+        for (GLuint c = 0; c < 4; c++) {
+            glm::vec4 column(0.0f);
+            column[c] = 1.0f;
+            glVertexAttrib4f(kInstanceMatrixLocation + c, column.x, column.y, column.z, column.w);
+        }
+    }
+
+    void Mesh::setInstanceAttributes(size_t byteOffset)
+    {
+        // a mat4 attribute is 4 vec4 columns on consecutive locations
+        for (GLuint c = 0; c < 4; c++) {
+            glEnableVertexAttribArray(kInstanceMatrixLocation + c);
+            glVertexAttribPointer(kInstanceMatrixLocation + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                (GLvoid*)(byteOffset + c * sizeof(glm::vec4)));
+            glVertexAttribDivisor(kInstanceMatrixLocation + c, 1);
+        }
+    }
+
+    // VAO bound by setupMesh
+    void Mesh::uploadInstances()
+    {
+        glGenBuffers(1, &instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::mat4), instances.data(), GL_STATIC_DRAW);
+
+        // layout(location=3..6) instance matrix
+        setInstanceAttributes(0);
+    }
+
+    // VBO bound by setupMesh (VAO + EBO already set up)
+    void Mesh::uploadPacked()
+    {
+        glm::vec3 minP(FLT_MAX), maxP(-FLT_MAX);
+        for (const auto& v : vertices) {
+            minP = glm::min(minP, v.Position);
+            maxP = glm::max(maxP, v.Position);
+        }
+        if (vertices.empty()) minP = maxP = glm::vec3(0.0f);
+
+        posOffset = minP;
+        posScale = maxP - minP;     // the attribute is normalized to [0, 1]
+
+        std::vector<PackedVertex> packed(vertices.size());
+        quantError = QuantizationError();
+
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vertex& v = vertices[i];
+            PackedVertex& p = packed[i];
+
+            glm::vec3 decoded;
+            for (int c = 0; c < 3; c++) {
+                float t = posScale[c] > 0.0f ? (v.Position[c] - posOffset[c]) / posScale[c] : 0.0f;
+                p.position[c] = (GLushort)std::lround(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f);
+                decoded[c] = posOffset[c] + posScale[c] * ((float)p.position[c] / 65535.0f);
+            }
+            p.position[3] = 0;
+
+            float len = glm::length(v.Normal);
+            glm::vec3 n = len > 0.0f ? v.Normal / len : glm::vec3(0.0f, 1.0f, 0.0f);
+            p.normal = glm::packSnorm3x10_1x2(glm::vec4(n, 0.0f));
+
+            p.texCoords[0] = glm::packHalf1x16(v.TexCoords.x);
+            p.texCoords[1] = glm::packHalf1x16(v.TexCoords.y);
+
+            // error report against the float path
+            quantError.position = std::max(quantError.position, glm::length(decoded - v.Position));
+
+            glm::vec3 nDecoded = glm::vec3(glm::unpackSnorm3x10_1x2(p.normal));
+            if (len > 0.0f && glm::length(nDecoded) > 0.0f) {
+                float cosAngle = glm::dot(n, glm::normalize(nDecoded));
+                float deg = glm::degrees(std::acos(std::min(std::max(cosAngle, -1.0f), 1.0f)));
+                quantError.normalDeg = std::max(quantError.normalDeg, deg);
+            }
+
+            glm::vec2 uvDecoded(glm::unpackHalf1x16(p.texCoords[0]), glm::unpackHalf1x16(p.texCoords[1]));
+            glm::vec2 uvDiff = glm::abs(uvDecoded - v.TexCoords);
+            quantError.texCoord = std::max(quantError.texCoord, std::max(uvDiff.x, uvDiff.y));
+        }
+
+        glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+
+        // layout(location=0) position, unorm16 -> [0, 1] (posOffset + posScale * p in the shader)
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+            (GLvoid*)offsetof(PackedVertex, position));
+
+        // layout(location=1) normal, signed 10:10:10:2 (the 2-bit w is ignored by the vec3 input)
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex),
+            (GLvoid*)offsetof(PackedVertex, normal));
+
+        // layout(location=2) texCoords, half floats
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex),
+            (GLvoid*)offsetof(PackedVertex, texCoords));
+    }
 }
@@ -23,6 +23,36 @@ namespace gps {
         glm::vec2 TexCoords;
     };
 
+    // GPU vertex layout, chosen once at load time (Model3D::setVertexFormat)
+    enum VertexFormat {
+        VERTEX_FLOAT,   // Vertex uploaded as is (32 bytes)
+        VERTEX_PACKED   // PackedVertex (16 bytes); vertex shaders need #define PACKED_VERTICES
+    };
+
+    // position: 16-bit unorm inside the mesh bounds, decoded as posOffset + posScale * q
+    // normal:   signed 10:10:10:2 (GL_INT_2_10_10_10_REV)
+    // uv:       half floats
+    struct PackedVertex {
+        GLushort position[4];       // w is padding, keeps the normal 4-byte aligned
+        GLuint normal;
+        GLushort texCoords[2];
+    };
+    static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+    // worst case of the packed attributes against the float ones (same mesh)
+    struct QuantizationError {
+        float position = 0.0f;      // MODEL-LOCAL units
+        float normalDeg = 0.0f;
+        float texCoord = 0.0f;
+    };
+
+    // one level of detail: a range of Mesh::indices; every LOD shares the mesh's vertex buffer
+    struct MeshLod {
+        GLsizei firstIndex;
+        GLsizei indexCount;
+        float error;                // MODEL-LOCAL geometric error against LOD 0
+    };
+
     struct Texture {
         GLuint id = 0;              // fix warning uninitialized
         std::string type;           // ambientTexture, diffuseTexture, specularTexture
@@ -45,7 +75,7 @@ namespace gps {
 
     public:
         std::vector<Vertex> vertices;
-        std::vector<GLuint> indices;
+        std::vector<GLuint> indices;        // every LOD, back to back (LOD 0 first)
         std::vector<Texture> textures;
 
         // NEW: Kd from MTL as fallback (when no diffuse texture)
@@ -55,15 +85,69 @@ namespace gps {
         Mesh(std::vector<Vertex> vertices,
             std::vector<GLuint> indices,
             std::vector<Texture> textures,
-            glm::vec3 kdColor);
+            glm::vec3 kdColor,
+            VertexFormat format = VERTEX_FLOAT,
+            std::vector<MeshLod> lods = {},     // empty: a single LOD covering all indices
+            std::vector<glm::mat4> instances = {});
 
-        Buffers getBuffers();
+        Buffers getBuffers() const;
 
         void Draw(gps::Shader shader);
 
+        // posScale / posOffset for the bound program (no-op for VERTEX_FLOAT)
+        void setDequantizeUniforms(GLuint program) const;
+
+        VertexFormat getVertexFormat() const { return format; }
+        size_t getVertexBytes() const;
+
+        // GL_UNSIGNED_SHORT when the mesh has <= kMaxShortIndexVertices vertices, else GL_UNSIGNED_INT
+        GLenum getIndexType() const { return indexType; }
+        size_t getIndexBytes() const;
+
+        static constexpr size_t kMaxShortIndexVertices = 65536;
+
+        const std::vector<MeshLod>& getLods() const { return lods; }
+        // the level used by Draw (and by Model3D's depth passes); clamped to the available ones
+        void selectLod(int lod);
+        int getSelectedLod() const { return selectedLod; }
+        const MeshLod& getSelectedLodRange() const { return lods[selectedLod]; }
+        // byte offset of a LOD's first index in the EBO
+        size_t getIndexOffset(const MeshLod& lod) const;
+        const QuantizationError& getQuantizationError() const { return quantError; }
+
+        // Hardware instancing: one MODEL-LOCAL matrix per copy of the mesh (locations 3..6,
+        // divisor 1), drawn with glDrawElementsInstanced. Not instanced: the attribute arrays stay
+        // disabled and the shaders read their constant value (setDefaultInstanceMatrix).
+        bool isInstanced() const { return !instances.empty(); }
+        const std::vector<glm::mat4>& getInstances() const { return instances; }
+        GLsizei getInstanceCount() const { return isInstanced() ? (GLsizei)instances.size() : 1; }
+        GLuint getInstanceBuffer() const { return instanceVBO; }
+
+        static constexpr GLuint kInstanceMatrixLocation = 3;
+        // constant value of locations 3..6 = identity. The current value of an attribute is
+        // undefined after a draw that sourced it from an array, so every instanced draw calls it again.
+        static void setDefaultInstanceMatrix();
+        // locations 3..6 of the bound VAO <- mat4s of the bound GL_ARRAY_BUFFER, from byteOffset
+        static void setInstanceAttributes(size_t byteOffset);
+
     private:
         Buffers buffers;
 
+        VertexFormat format = VERTEX_FLOAT;
+        GLenum indexType = GL_UNSIGNED_INT;
+
+        std::vector<MeshLod> lods;
+        int selectedLod = 0;
+        glm::vec3 posScale = glm::vec3(1.0f);
+        glm::vec3 posOffset = glm::vec3(0.0f);
+        QuantizationError quantError;
+
+        std::vector<glm::mat4> instances;
+        GLuint instanceVBO = 0;
+
+        void uploadPacked();
+        void uploadInstances();
+
         void setupMesh();
     };
 
@@ -0,0 +1,251 @@
+#include "MeshSimplifier.hpp"
+#include "CpuProfiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace gps {
+
+    // ---- Quadric (a[] = xx xy xz xd yy yz yd zz zd dd) ----
+
+    void MeshSimplifier::Quadric::addPlane(double nx, double ny, double nz, double d, double weight)
+    {
+        a[0] += weight * nx * nx; a[1] += weight * nx * ny; a[2] += weight * nx * nz; a[3] += weight * nx * d;
+        a[4] += weight * ny * ny; a[5] += weight * ny * nz; a[6] += weight * ny * d;
+        a[7] += weight * nz * nz; a[8] += weight * nz * d;
+        a[9] += weight * d * d;
+        this->weight += weight;
+    }
+
+    void MeshSimplifier::Quadric::add(const Quadric& q)
+    {
+        for (int i = 0; i < 10; i++) a[i] += q.a[i];
+        weight += q.weight;
+    }
+
+    double MeshSimplifier::Quadric::evaluate(const glm::vec3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+            + a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+            + a[7] * z * z + 2.0 * a[8] * z
+            + a[9];
+    }
+
+    // ---- MeshSimplifier ----
+
+    static uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        if (a > b) std::swap(a, b);
+        return ((uint64_t)a << 32) | b;
+    }
+
+    MeshSimplifier::MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices)
+    {
+        size_t vertexCount = vertices.size();
+        size_t triangleCount = indices.size() / 3;
+
+        positions.resize(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) positions[i] = vertices[i].Position;
+
+        triangles.assign(indices.begin(), indices.begin() + triangleCount * 3);
+        triangleAlive.assign(triangleCount, false);
+        vertexTriangles.resize(vertexCount);
+        quadrics.resize(vertexCount);
+        locked.assign(vertexCount, false);
+        collapsed.assign(vertexCount, false);
+        stamps.assign(vertexCount, 0);
+
+        std::unordered_map<uint64_t, int> edgeUse;
+        edgeUse.reserve(triangleCount * 3);
+
+        for (size_t t = 0; t < triangleCount; t++) {
+            uint32_t i0 = triangles[3 * t + 0], i1 = triangles[3 * t + 1], i2 = triangles[3 * t + 2];
+            if (i0 == i1 || i1 == i2 || i0 == i2) continue;
+
+            triangleAlive[t] = true;
+            liveTriangles++;
+            for (int k = 0; k < 3; k++) vertexTriangles[triangles[3 * t + k]].push_back((uint32_t)t);
+
+            edgeUse[edgeKey(i0, i1)]++;
+            edgeUse[edgeKey(i1, i2)]++;
+            edgeUse[edgeKey(i2, i0)]++;
+
+            // plane quadric, area weighted
+            glm::vec3 n = glm::cross(positions[i1] - positions[i0], positions[i2] - positions[i0]);
+            float len = glm::length(n);
+            if (len <= 0.0f) continue;
+            n /= len;
+            double d = -glm::dot(n, positions[i0]);
+            for (int k = 0; k < 3; k++)
+                quadrics[triangles[3 * t + k]].addPlane(n.x, n.y, n.z, d, 0.5 * len);
+        }
+
+        // open / non-manifold edges: material and chunk borders, attribute seams
+        for (const auto& kv : edgeUse) {
+            if (kv.second == 2) continue;
+            locked[(uint32_t)(kv.first >> 32)] = true;
+            locked[(uint32_t)(kv.first & 0xFFFFFFFFu)] = true;
+        }
+
+        // a position used by several vertices is a seam even where the edges look closed
+        struct PositionKey {
+            uint32_t x, y, z;
+            bool operator==(const PositionKey& o) const { return x == o.x && y == o.y && z == o.z; }
+        };
+        struct PositionKeyHash {
+            size_t operator()(const PositionKey& k) const { return (k.x * 73856093u) ^ (k.y * 19349663u) ^ (k.z * 83492791u); }
+        };
+        std::unordered_map<PositionKey, uint32_t, PositionKeyHash> firstAtPosition;
+        firstAtPosition.reserve(vertexCount);
+        for (uint32_t v = 0; v < (uint32_t)vertexCount; v++) {
+            PositionKey key;
+            std::memcpy(&key.x, &positions[v].x, 4);
+            std::memcpy(&key.y, &positions[v].y, 4);
+            std::memcpy(&key.z, &positions[v].z, 4);
+
+            auto it = firstAtPosition.find(key);
+            if (it == firstAtPosition.end()) {
+                firstAtPosition.emplace(key, v);
+            }
+            else {
+                locked[v] = true;
+                locked[it->second] = true;
+            }
+        }
+
+        for (size_t t = 0; t < triangleCount; t++) {
+            if (!triangleAlive[t]) continue;
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = triangles[3 * t + k], b = triangles[3 * t + (k + 1) % 3];
+                pushCandidate(a, b);
+                pushCandidate(b, a);
+            }
+        }
+    }
+
+    void MeshSimplifier::pushCandidate(uint32_t from, uint32_t to)
+    {
+        if (locked[from]) return;
+
+        Quadric q = quadrics[from];
+        q.add(quadrics[to]);
+
+        Candidate c;
+        c.cost = std::max(0.0, q.evaluate(positions[to]));
+        c.error = q.weight > 0.0 ? (float)std::sqrt(c.cost / q.weight) : 0.0f;
+        c.from = from;
+        c.to = to;
+        c.fromStamp = stamps[from];
+        c.toStamp = stamps[to];
+        heap.push(c);
+    }
+
+    void MeshSimplifier::pushCandidates(uint32_t v)
+    {
+        for (uint32_t t : vertexTriangles[v]) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t w = triangles[3 * t + k];
+                if (w == v) continue;
+                pushCandidate(w, v);
+                pushCandidate(v, w);
+            }
+        }
+    }
+
+    bool MeshSimplifier::sharesTriangle(uint32_t a, uint32_t b) const
+    {
+        for (uint32_t t : vertexTriangles[a]) {
+            if (!triangleAlive[t]) continue;
+            if (triangles[3 * t] == b || triangles[3 * t + 1] == b || triangles[3 * t + 2] == b) return true;
+        }
+        return false;
+    }
+
+    // moving 'from' onto 'to' must not fold or squash the triangles that survive the collapse
+    bool MeshSimplifier::collapseFlipsTriangles(uint32_t from, uint32_t to) const
+    {
+        for (uint32_t t : vertexTriangles[from]) {
+            if (!triangleAlive[t]) continue;
+
+            const uint32_t* tri = &triangles[3 * t];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) continue;   // removed by the collapse
+
+            glm::vec3 p[3], q[3];
+            for (int k = 0; k < 3; k++) {
+                p[k] = positions[tri[k]];
+                q[k] = positions[tri[k] == from ? to : tri[k]];
+            }
+
+            glm::vec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+            glm::vec3 n1 = glm::cross(q[1] - q[0], q[2] - q[0]);
+            float l0 = glm::length(n0), l1 = glm::length(n1);
+            if (l1 <= 1e-6f * l0) return true;
+            if (glm::dot(n0, n1) < 0.2f * l0 * l1) return true;
+        }
+        return false;
+    }
+
+    void MeshSimplifier::collapse(uint32_t from, uint32_t to)
+    {
+        for (uint32_t t : vertexTriangles[from]) {
+            if (!triangleAlive[t]) continue;
+
+            uint32_t* tri = &triangles[3 * t];
+            if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                triangleAlive[t] = false;
+                liveTriangles--;
+                continue;
+            }
+
+            for (int k = 0; k < 3; k++)
+                if (tri[k] == from) tri[k] = to;
+            vertexTriangles[to].push_back(t);
+        }
+
+        vertexTriangles[from].clear();
+        collapsed[from] = true;
+        quadrics[to].add(quadrics[from]);
+
+        std::vector<uint32_t>& list = vertexTriangles[to];
+        list.erase(std::remove_if(list.begin(), list.end(),
+            [this](uint32_t t) { return !triangleAlive[t]; }), list.end());
+
+        // every queued candidate touching 'to' is stale now
+        stamps[to]++;
+        pushCandidates(to);
+    }
+
+    void MeshSimplifier::simplifyTo(size_t targetTriangles)
+    {
+        WT_PROFILE_FUNCTION();
+
+        while (liveTriangles > targetTriangles && !heap.empty()) {
+            Candidate c = heap.top();
+            heap.pop();
+
+            if (collapsed[c.from] || collapsed[c.to]) continue;
+            if (c.fromStamp != stamps[c.from] || c.toStamp != stamps[c.to]) continue;
+            if (!sharesTriangle(c.from, c.to)) continue;
+            if (collapseFlipsTriangles(c.from, c.to)) continue;
+
+            maxError = std::max(maxError, c.error);
+            collapse(c.from, c.to);
+        }
+    }
+
+    std::vector<GLuint> MeshSimplifier::getIndices() const
+    {
+        std::vector<GLuint> out;
+        out.reserve(liveTriangles * 3);
+        for (size_t t = 0; t < triangleAlive.size(); t++) {
+            if (!triangleAlive[t]) continue;
+            out.push_back(triangles[3 * t + 0]);
+            out.push_back(triangles[3 * t + 1]);
+            out.push_back(triangles[3 * t + 2]);
+        }
+        return out;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef MeshSimplifier_hpp
+#define MeshSimplifier_hpp
+
+#include "Mesh.hpp"
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+namespace gps {
+
+    // Quadric error metric edge collapse (Garland & Heckbert), vertex-restricted: a vertex is
+    // always collapsed onto one of its neighbours, so every LOD indexes the original vertex
+    // buffer and only needs its own index list. Vertices on open edges (material / chunk
+    // borders, UV and normal seams after welding) and vertices sharing a position with another
+    // vertex are never moved, so seams stay closed at every level.
+    //
+    // simplifyTo() is progressive: call it with decreasing targets to build a LOD chain.
+    class MeshSimplifier {
+
+    public:
+        MeshSimplifier(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices);
+
+        // collapses edges until at most targetTriangles remain (or nothing valid is left)
+        void simplifyTo(size_t targetTriangles);
+
+        std::vector<GLuint> getIndices() const;
+        size_t getTriangleCount() const { return liveTriangles; }
+        // largest geometric error introduced so far: MODEL-LOCAL distance, the RMS distance of a
+        // collapsed vertex to the planes it gathered (quadric cost / summed plane weight)
+        float getError() const { return maxError; }
+
+    private:
+        struct Quadric {
+            double a[10] = {};      // upper triangle of the symmetric 4x4 matrix
+            double weight = 0.0;    // sum of the plane weights (areas)
+
+            void addPlane(double nx, double ny, double nz, double d, double weight);
+            void add(const Quadric& q);
+            double evaluate(const glm::vec3& p) const;
+        };
+
+        struct Candidate {
+            double cost;            // area weighted: orders the collapses
+            float error;            // distance: what getError() reports
+            uint32_t from, to;
+            uint32_t fromStamp, toStamp;
+            bool operator>(const Candidate& o) const { return cost > o.cost; }
+        };
+
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> triangles;            // 3 per triangle, rewritten by collapses
+        std::vector<bool> triangleAlive;
+        std::vector<std::vector<uint32_t>> vertexTriangles;
+        std::vector<Quadric> quadrics;
+        std::vector<bool> locked;
+        std::vector<bool> collapsed;
+        std::vector<uint32_t> stamps;               // bumped when a vertex's neighbourhood changes
+
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+
+        size_t liveTriangles = 0;
+        float maxError = 0.0f;
+
+        void pushCandidates(uint32_t v);
+        void pushCandidate(uint32_t from, uint32_t to);
+        bool sharesTriangle(uint32_t a, uint32_t b) const;
+        bool collapseFlipsTriangles(uint32_t from, uint32_t to) const;
+        void collapse(uint32_t from, uint32_t to);
+    };
+}
+
+#endif /* MeshSimplifier_hpp */
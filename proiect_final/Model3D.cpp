@@ -1,8 +1,14 @@
 #include "Model3D.hpp"
+#include "RenderStats.hpp"
+#include "CpuProfiler.hpp"
+#include "MeshSimplifier.hpp"
+#include "JobSystem.hpp"
 #include <unordered_map>
 #include <cfloat>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 
 namespace gps {
 
@@ -18,6 +24,28 @@ namespace gps {
         return name.find("Terrain") != std::string::npos || name.find("terrain") != std::string::npos;
     }
 
+    static bool isLightbulbMaterialName(const std::string& name)
+    {
+        return name.find("lightbulb") != std::string::npos;
+    }
+
+    // --- union-find for grouping bulb faces into connected components
+    static int findRoot(std::vector<int>& parent, int i)
+    {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    static void unite(std::vector<int>& parent, int a, int b)
+    {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a != b) parent[b] = a;
+    }
+
     static glm::vec3 vmin3(const glm::vec3& a, const glm::vec3& b) {
         return glm::vec3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
     }
@@ -82,18 +110,717 @@ namespace gps {
     void Model3D::LoadModel(std::string fileName)
     {
         std::string basePath = fileName.substr(0, fileName.find_last_of('/')) + "/";
-        ReadOBJ(fileName, basePath);
+        LoadModel(fileName, basePath);
     }
 
     void Model3D::LoadModel(std::string fileName, std::string basePath)
     {
-        ReadOBJ(fileName, basePath);
+        startLoad(fileName, basePath);
+
+        // the loader thread and the decode jobs do the work, this thread only uploads
+        while (!pumpUploads(0.0)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    void Model3D::LoadModelAsync(std::string fileName)
+    {
+        std::string basePath = fileName.substr(0, fileName.find_last_of('/')) + "/";
+        startLoad(fileName, basePath);
+    }
+
+    void Model3D::startLoad(std::string fileName, std::string basePath)
+    {
+        cancelLoad();
+
+        meshes.clear();
+        meshBounds.clear();
+        clusterableMeshes.clear();
+        clusterOfMesh.clear();
+        meshFade.clear();
+        meshCulled.clear();
+        emissiveLightsLocal.clear();
+        requestedTextures.clear();
+        collisionReady = false;
+        loadCancelled = false;
+        loaderDone = false;
+        loaderFailed = false;
+        geometryComplete = false;
+        loaded = false;
+        loadFailed = false;
+
+        loader = std::thread(&Model3D::ReadOBJ, this, fileName, basePath);
+    }
+
+    void Model3D::cancelLoad()
+    {
+        loadCancelled = true;
+        if (loader.joinable()) loader.join();
+    }
+
+    bool Model3D::pumpUploads(double budgetMs)
+    {
+        WT_PROFILE_FUNCTION();
+
+        if (loaded || loadFailed) return true;
+
+        auto t0 = std::chrono::steady_clock::now();
+        auto overBudget = [&]() {
+            return budgetMs > 0.0
+                && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() >= budgetMs;
+        };
+
+        if (!placeholderTexture) {
+            // light grey: reads as "not textured yet" without changing the scene's brightness much
+            const unsigned char grey[4] = { 180, 180, 180, 255 };
+            glGenTextures(1, &placeholderTexture);
+            glBindTexture(GL_TEXTURE_2D, placeholderTexture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        bool loaderFinished, loaderFailedNow;
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            for (auto& pending : pendingMeshes) meshUploads.push_back(std::move(pending));
+            pendingMeshes.clear();
+            for (auto& decoded : decodedTextures) textureUploads.push_back(std::move(decoded));
+            decodedTextures.clear();
+            loaderFinished = loaderDone;
+            loaderFailedNow = loaderFailed;
+        }
+
+        // nothing was parsed: the caller decides how to shut down (GL objects stay on this thread)
+        if (loaderFailedNow) {
+            loadFailed = true;
+            glDeleteTextures(1, &placeholderTexture);
+            placeholderTexture = 0;
+            return true;
+        }
+
+        // textures first: they replace placeholders on meshes already on screen
+        bool uploaded = false;
+        while (!textureUploads.empty() && !(uploaded && overBudget())) {
+            uploadTexture(textureUploads.front());
+            textureUploads.pop_front();
+            uploaded = true;
+        }
+
+        size_t meshesBefore = meshes.size();
+        while (!meshUploads.empty() && !(uploaded && overBudget())) {
+            uploadMesh(meshUploads.front());
+            meshUploads.pop_front();
+            uploaded = true;
+        }
+        if (meshes.size() != meshesBefore) Mesh::setDefaultInstanceMatrix();
+
+        if (!geometryComplete && loaderFinished && meshUploads.empty()) finalizeGeometry();
+
+        loaded = geometryComplete && textureUploads.empty() && texturesPending == 0;
+        if (loaded) {
+            // every mesh has its real texture (or none, for unreadable files) by now
+            glDeleteTextures(1, &placeholderTexture);
+            placeholderTexture = 0;
+        }
+        return loaded;
+    }
+
+    void Model3D::uploadMesh(PendingMesh& pending)
+    {
+        // textures uploaded so far have their GL id, the others sample the placeholder until uploadTexture
+        for (auto& texture : pending.textures) {
+            texture.id = placeholderTexture;
+            for (const auto& loadedTexture : loadedTextures) {
+                if (loadedTexture.path == texture.path) {
+                    texture.id = loadedTexture.id;
+                    break;
+                }
+            }
+        }
+
+        meshes.push_back(gps::Mesh(std::move(pending.vertices), std::move(pending.indices), std::move(pending.textures),
+            pending.kd, vertexFormat, std::move(pending.lods), std::move(pending.instances)));
+        const Mesh& mesh = meshes.back();
+
+        AABB bounds;
+        bounds.minP = glm::vec3(FLT_MAX);
+        bounds.maxP = glm::vec3(-FLT_MAX);
+        for (const auto& v : mesh.vertices) {
+            bounds.minP = vmin3(bounds.minP, v.Position);
+            bounds.maxP = vmax3(bounds.maxP, v.Position);
+        }
+
+        if (mesh.isInstanced()) {
+            AABB prototype = bounds;
+            bounds.minP = glm::vec3(FLT_MAX);
+            bounds.maxP = glm::vec3(-FLT_MAX);
+            for (const auto& m : mesh.getInstances()) {
+                glm::vec3 copyMin, copyMax;
+                transformAABBToWorld(m, prototype.minP, prototype.maxP, copyMin, copyMax);
+                bounds.minP = vmin3(bounds.minP, copyMin);
+                bounds.maxP = vmax3(bounds.maxP, copyMax);
+            }
+        }
+
+        meshBounds.push_back(bounds);
+        clusterableMeshes.push_back(pending.clusterable);
+        clusterOfMesh.push_back(-1);
+        meshFade.push_back(0.0f);
+        meshCulled.push_back(0);
+    }
+
+    // every mesh is on the GPU: the passes and data that need the whole scene
+    void Model3D::finalizeGeometry()
+    {
+        if (loader.joinable()) loader.join();
+
+        setupDepthStream();
+        Mesh::setDefaultInstanceMatrix();
+        reportMeshBuffers();
+        buildClusters(clusterableMeshes);
+
+        std::lock_guard<std::mutex> lock(loadMutex);
+        emissiveLightsLocal = std::move(pendingEmissiveLights);
+        geometryComplete = true;
     }
 
     void Model3D::Draw(gps::Shader shaderProgram)
     {
-        for (int i = 0; i < (int)meshes.size(); i++)
+        for (int i = 0; i < (int)meshes.size(); i++) {
+            if (meshFade[i] > 0.0f || meshCulled[i]) continue;   // cross-fading, replaced by its impostor or fogged out
+            meshes[i].Draw(shaderProgram);
+        }
+    }
+
+    void Model3D::DrawFading(gps::Shader shaderProgram)
+    {
+        shaderProgram.useShaderProgram();
+        GLint fadeLoc = glGetUniformLocation(shaderProgram.shaderProgram, "lodFade");
+
+        for (int i = 0; i < (int)meshes.size(); i++) {
+            if (meshFade[i] <= 0.0f || meshFade[i] >= 1.0f || meshCulled[i]) continue;
+            glUniform1f(fadeLoc, meshFade[i]);
             meshes[i].Draw(shaderProgram);
+        }
+    }
+
+    void Model3D::DrawCluster(int cluster, gps::Shader shaderProgram)
+    {
+        for (int i : clusters[cluster].meshes) {
+            int selected = meshes[i].getSelectedLod();
+            meshes[i].selectLod(0);
+            meshes[i].Draw(shaderProgram);
+            meshes[i].selectLod(selected);
+        }
+    }
+
+    void Model3D::setClusterFades(const std::vector<float>& fades)
+    {
+        for (size_t i = 0; i < meshes.size(); i++) {
+            int c = clusterOfMesh[i];
+            meshFade[i] = (c >= 0 && c < (int)fades.size()) ? fades[c] : 0.0f;
+        }
+    }
+
+    void Model3D::DrawDepth()
+    {
+        if (depthStream.indexCount == 0) return;
+
+        glBindVertexArray(depthStream.VAO);
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, depthStream.counts.data(), depthStream.indexType,
+            depthStream.offsets.data(), (GLsizei)depthStream.ranges.size(), depthStream.baseVertices.data());
+        renderStats.addDraw(depthStream.selectedIndexCount);
+
+        for (int i : depthStream.instancedMeshes) drawDepthInstanced(i);
+        glBindVertexArray(0);
+        if (!depthStream.instancedMeshes.empty()) Mesh::setDefaultInstanceMatrix();
+    }
+
+    // one instanced draw from the shared stream; leaves instancedVAO bound
+    void Model3D::drawDepthInstanced(int mesh) const
+    {
+        const DepthRange& r = depthStream.ranges[mesh];
+        const MeshLod& lod = meshes[mesh].getSelectedLodRange();
+        GLsizei copies = meshes[mesh].getInstanceCount();
+
+        glBindVertexArray(depthStream.instancedVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, depthStream.instanceVBO);
+        Mesh::setInstanceAttributes(r.instanceOffset);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, lod.indexCount, depthStream.indexType,
+            depthStream.offsets[mesh], copies, r.baseVertex);
+        renderStats.addDraw(lod.indexCount * copies);
+    }
+
+    // squared distance from p to the box (0 when inside)
+    static float distanceSqToAABB(const glm::vec3& p, const glm::vec3& bmin, const glm::vec3& bmax)
+    {
+        glm::vec3 q = vmin3(vmax3(p, bmin), bmax);
+        glm::vec3 d = p - q;
+        return glm::dot(d, d);
+    }
+
+    void Model3D::DrawDepthSorted(const glm::vec3& eyeLocal)
+    {
+        if (depthStream.indexCount == 0) return;
+
+        depthOrder.clear();
+        for (int i = 0; i < (int)depthStream.ranges.size(); i++) {
+            if (meshFade[i] > 0.0f || meshCulled[i]) continue;   // drawn after the GL_EQUAL pass (DrawFading), as an impostor or not at all
+            const AABB& b = meshBounds[i];
+            depthOrder.push_back({ distanceSqToAABB(eyeLocal, b.minP, b.maxP), i });
+        }
+        std::sort(depthOrder.begin(), depthOrder.end());
+
+        // packed: the shared stream holds float positions, so draw the quantized mesh buffers
+        // (same values + same decode as the main pass)
+        if (vertexFormat == VERTEX_PACKED) {
+            GLint program = 0;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+            for (const auto& entry : depthOrder) {
+                const Mesh& mesh = meshes[entry.second];
+                mesh.setDequantizeUniforms((GLuint)program);
+
+                const MeshLod& lod = mesh.getSelectedLodRange();
+                glBindVertexArray(mesh.getBuffers().VAO);
+                glDrawElementsInstanced(GL_TRIANGLES, lod.indexCount, mesh.getIndexType(), (GLvoid*)mesh.getIndexOffset(lod),
+                    mesh.getInstanceCount());
+                renderStats.addDraw(lod.indexCount * mesh.getInstanceCount());
+                if (mesh.isInstanced()) Mesh::setDefaultInstanceMatrix();
+            }
+            glBindVertexArray(0);
+            return;
+        }
+
+        glBindVertexArray(depthStream.VAO);
+        for (const auto& entry : depthOrder) {
+            int i = entry.second;
+            if (meshes[i].isInstanced()) {
+                drawDepthInstanced(i);
+                Mesh::setDefaultInstanceMatrix();
+                glBindVertexArray(depthStream.VAO);
+                continue;
+            }
+
+            glDrawElementsBaseVertex(GL_TRIANGLES, depthStream.counts[i], depthStream.indexType,
+                depthStream.offsets[i], depthStream.baseVertices[i]);
+            renderStats.addDraw(depthStream.counts[i]);
+        }
+        glBindVertexArray(0);
+    }
+
+    void Model3D::cullBeyond(const glm::vec3& eyeLocal, float maxDistance)
+    {
+        float maxDistanceSq = maxDistance * maxDistance;
+
+        auto cullRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const AABB& b = meshBounds[i];
+                meshCulled[i] = maxDistance > 0.0f && distanceSqToAABB(eyeLocal, b.minP, b.maxP) > maxDistanceSq;
+            }
+        };
+
+        if (jobs) jobs->parallelFor(meshBounds.size(), kJobGrainMeshes, cullRange);
+        else cullRange(0, meshBounds.size());
+    }
+
+    void Model3D::setupDepthStream()
+    {
+        std::vector<glm::vec3> positions;
+        std::vector<GLuint> indices;
+
+        size_t vertexTotal = 0, indexTotal = 0;
+        bool shortIndices = true;
+        for (const auto& mesh : meshes) {
+            vertexTotal += mesh.vertices.size();
+            indexTotal += mesh.indices.size();
+            shortIndices = shortIndices && mesh.vertices.size() <= Mesh::kMaxShortIndexVertices;
+        }
+        positions.reserve(vertexTotal);
+        indices.reserve(indexTotal);
+
+        depthStream.ranges.clear();
+        depthStream.ranges.reserve(meshes.size());
+        depthStream.instancedMeshes.clear();
+        std::vector<glm::mat4> instances;
+
+        for (const auto& mesh : meshes) {
+            DepthRange range;
+            range.firstIndex = (GLsizei)indices.size();
+            range.indexCount = (GLsizei)mesh.indices.size();
+            range.baseVertex = (GLint)positions.size();
+            range.instanceOffset = instances.size() * sizeof(glm::mat4);
+
+            for (const auto& v : mesh.vertices) positions.push_back(v.Position);
+            indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+
+            if (mesh.isInstanced()) {
+                instances.insert(instances.end(), mesh.getInstances().begin(), mesh.getInstances().end());
+                depthStream.instancedMeshes.push_back((int)depthStream.ranges.size());
+            }
+
+            depthStream.ranges.push_back(range);
+        }
+
+        depthStream.indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        updateDepthDraws();
+        meshCulled.assign(meshes.size(), 0);
+
+        glGenVertexArrays(1, &depthStream.VAO);
+        glGenBuffers(1, &depthStream.VBO);
+        glGenBuffers(1, &depthStream.EBO);
+
+        glBindVertexArray(depthStream.VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, depthStream.VBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, depthStream.EBO);
+        if (shortIndices) {
+            std::vector<GLushort> shortData(indices.begin(), indices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortData.size() * sizeof(GLushort), shortData.data(), GL_STATIC_DRAW);
+        }
+        else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+        }
+
+        // layout(location=0) position only
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+
+        // instanced meshes: same positions + indices, locations 3..6 set per draw (drawDepthInstanced)
+        if (!instances.empty()) {
+            glGenVertexArrays(1, &depthStream.instancedVAO);
+            glGenBuffers(1, &depthStream.instanceVBO);
+
+            glBindVertexArray(depthStream.instancedVAO);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, depthStream.EBO);
+            glBindBuffer(GL_ARRAY_BUFFER, depthStream.VBO);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (GLvoid*)0);
+
+            glBindBuffer(GL_ARRAY_BUFFER, depthStream.instanceVBO);
+            glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(glm::mat4), instances.data(), GL_STATIC_DRAW);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        depthStream.indexCount = (GLsizei)indices.size();
+
+        std::cout << "Depth stream: " << positions.size() << " positions, "
+            << indices.size() / 3 << " triangles, "
+            << (shortIndices ? "16" : "32") << "-bit indices" << std::endl;
+    }
+
+    // per-range draw arguments for the LOD each mesh currently uses
+    void Model3D::updateDepthDraws()
+    {
+        size_t indexSize = depthStream.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+        depthStream.counts.resize(depthStream.ranges.size());
+        depthStream.offsets.resize(depthStream.ranges.size());
+        depthStream.baseVertices.resize(depthStream.ranges.size());
+        depthStream.selectedIndexCount = 0;
+
+        for (size_t i = 0; i < depthStream.ranges.size(); i++) {
+            const DepthRange& r = depthStream.ranges[i];
+            const MeshLod& lod = meshes[i].getSelectedLodRange();
+            bool instanced = meshes[i].isInstanced();
+
+            // instanced meshes are skipped by the multi-draw and drawn by drawDepthInstanced
+            depthStream.counts[i] = instanced ? 0 : lod.indexCount;
+            depthStream.offsets[i] = (const GLvoid*)((size_t)(r.firstIndex + lod.firstIndex) * indexSize);
+            depthStream.baseVertices[i] = r.baseVertex;
+            if (!instanced) depthStream.selectedIndexCount += lod.indexCount;
+        }
+    }
+
+    void Model3D::selectLods(const glm::vec3& eyeLocal, float pixelsPerUnit, float maxErrorPx)
+    {
+        WT_PROFILE_FUNCTION();
+
+        // every mesh only writes its own selection
+        auto selectRange = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                Mesh& mesh = meshes[i];
+                const std::vector<MeshLod>& lods = mesh.getLods();
+
+                int lod = 0;
+                if (maxErrorPx > 0.0f) {
+                    const AABB& b = meshBounds[i];
+                    float distance = std::sqrt(distanceSqToAABB(eyeLocal, b.minP, b.maxP));
+
+                    // coarsest level whose error, projected at the closest point of the mesh, stays under the budget
+                    for (int l = (int)lods.size() - 1; l > 0; l--) {
+                        if (lods[l].error * pixelsPerUnit <= maxErrorPx * distance) {
+                            lod = l;
+                            break;
+                        }
+                    }
+                }
+                mesh.selectLod(lod);
+            }
+        };
+
+        if (jobs) jobs->parallelFor(meshes.size(), kJobGrainMeshes, selectRange);
+        else selectRange(0, meshes.size());
+
+        updateDepthDraws();
+    }
+
+    void Model3D::reportMeshBuffers() const
+    {
+        size_t vertexCount = 0, gpuBytes = 0;
+        size_t indexCount = 0, indexBytes = 0, shortMeshes = 0;
+        QuantizationError worst;
+        for (const auto& mesh : meshes) {
+            vertexCount += mesh.vertices.size();
+            gpuBytes += mesh.getVertexBytes();
+            indexCount += mesh.indices.size();
+            indexBytes += mesh.getIndexBytes();
+            if (mesh.getIndexType() == GL_UNSIGNED_SHORT) shortMeshes++;
+
+            const QuantizationError& e = mesh.getQuantizationError();
+            worst.position = std::max(worst.position, e.position);
+            worst.normalDeg = std::max(worst.normalDeg, e.normalDeg);
+            worst.texCoord = std::max(worst.texCoord, e.texCoord);
+        }
+
+        std::cout << "Vertex format: " << (vertexFormat == VERTEX_PACKED ? "packed" : "float") << ", "
+            << vertexCount << " vertices, " << gpuBytes / 1024 << " KB (float: "
+            << vertexCount * sizeof(Vertex) / 1024 << " KB)" << std::endl;
+
+        if (vertexFormat == VERTEX_PACKED) {
+            std::cout << "Vertex format: max error vs float - position " << worst.position
+                << " | normal " << worst.normalDeg << " deg | uv " << worst.texCoord << std::endl;
+        }
+
+        // scene triangles if every mesh used level l (meshes with fewer levels stay on their last)
+        size_t levelTriangles[kMaxLods] = {};
+        for (const auto& mesh : meshes) {
+            const std::vector<MeshLod>& lods = mesh.getLods();
+            for (int l = 0; l < kMaxLods; l++)
+                levelTriangles[l] += lods[std::min(l, (int)lods.size() - 1)].indexCount / 3;
+        }
+        std::cout << "LODs (triangles per level):";
+        for (int l = 0; l < kMaxLods; l++) std::cout << " " << levelTriangles[l];
+        std::cout << std::endl;
+
+        std::cout << "Index buffers: " << shortMeshes << "/" << meshes.size() << " meshes 16-bit, "
+            << indexBytes / 1024 << " KB (32-bit: " << indexCount * sizeof(GLuint) / 1024 << " KB)" << std::endl;
+    }
+
+    // LOD 0 + simplified levels, all stored in the mesh's index buffer; uploaded by pumpUploads
+    void Model3D::addMesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+        const std::vector<Texture>& textures, const glm::vec3& kd, bool clusterable,
+        const std::vector<glm::mat4>& instances)
+    {
+        std::vector<GLuint> lodIndices = indices;
+        std::vector<MeshLod> lods;
+        buildLods(vertices, lodIndices, lods);
+
+        PendingMesh pending{ vertices, std::move(lodIndices), std::move(lods), textures, kd, instances, clusterable };
+
+        std::lock_guard<std::mutex> lock(loadMutex);
+        pendingMeshes.push_back(std::move(pending));
+    }
+
+    void Model3D::buildLods(const std::vector<Vertex>& vertices, std::vector<GLuint>& inOutIndices,
+        std::vector<MeshLod>& outLods) const
+    {
+        WT_PROFILE_FUNCTION();
+
+        size_t baseTriangles = inOutIndices.size() / 3;
+        outLods.clear();
+        outLods.push_back({ 0, (GLsizei)inOutIndices.size(), 0.0f });
+        if (baseTriangles < kLodMinTriangles) return;
+
+        MeshSimplifier simplifier(vertices, inOutIndices);
+        size_t previous = baseTriangles;
+        for (int l = 1; l < kMaxLods; l++) {
+            simplifier.simplifyTo((size_t)(previous * kLodRatio));
+
+            // mostly locked (seams, borders): another level would barely save anything
+            size_t count = simplifier.getTriangleCount();
+            if (count == 0 || count > previous * 85 / 100) break;
+
+            std::vector<GLuint> lodIndices = simplifier.getIndices();
+            outLods.push_back({ (GLsizei)inOutIndices.size(), (GLsizei)lodIndices.size(), simplifier.getError() });
+            inOutIndices.insert(inOutIndices.end(), lodIndices.begin(), lodIndices.end());
+            previous = count;
+        }
+    }
+
+    // One Mesh per <= Mesh::kMaxShortIndexVertices vertices, so every mesh gets 16-bit indices.
+    // Triangles are taken in order; vertices shared across a chunk border are duplicated.
+    // Instanced: every chunk gets the same instance matrices.
+    void Model3D::addMeshChunks(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+        const std::vector<Texture>& textures, const glm::vec3& kd, bool clusterable,
+        const std::vector<glm::mat4>& instances)
+    {
+        if (vertices.size() <= Mesh::kMaxShortIndexVertices) {
+            addMesh(vertices, indices, textures, kd, clusterable, instances);
+            return;
+        }
+
+        const GLuint kUnmapped = 0xFFFFFFFFu;
+        std::vector<GLuint> chunkIndexOf(vertices.size(), kUnmapped);
+        std::vector<GLuint> mappedVertices;     // to reset chunkIndexOf cheaply
+        std::vector<Vertex> chunkVertices;
+        std::vector<GLuint> chunkIndices;
+
+        auto flushChunk = [&]() {
+            if (chunkIndices.empty()) return;
+            addMesh(chunkVertices, chunkIndices, textures, kd, clusterable, instances);
+
+            for (GLuint v : mappedVertices) chunkIndexOf[v] = kUnmapped;
+            mappedVertices.clear();
+            chunkVertices.clear();
+            chunkIndices.clear();
+        };
+
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            // a triangle adds at most 3 new vertices
+            if (chunkVertices.size() + 3 > Mesh::kMaxShortIndexVertices) flushChunk();
+
+            for (int k = 0; k < 3; k++) {
+                GLuint v = indices[t + k];
+                if (chunkIndexOf[v] == kUnmapped) {
+                    chunkIndexOf[v] = (GLuint)chunkVertices.size();
+                    chunkVertices.push_back(vertices[v]);
+                    mappedVertices.push_back(v);
+                }
+                chunkIndices.push_back(chunkIndexOf[v]);
+            }
+        }
+        flushChunk();
+    }
+
+    // --- OBJ corner identity for welding: same (position, normal, uv) indices => same vertex
+    struct ObjIndexKey {
+        int vertex, normal, texcoord;
+        bool operator==(const ObjIndexKey& o) const {
+            return vertex == o.vertex && normal == o.normal && texcoord == o.texcoord;
+        }
+    };
+
+    struct ObjIndexKeyHash {
+        size_t operator()(const ObjIndexKey& k) const {
+            return ((size_t)(unsigned int)k.vertex * 73856093u)
+                ^ ((size_t)(unsigned int)k.normal * 19349663u)
+                ^ ((size_t)(unsigned int)k.texcoord * 83492791u);
+        }
+    };
+
+    // --- repeated props: a submesh and its copies share the vertex order (duplicated objects are
+    // exported face by face in the same order), so a copy is the prototype under one rigid
+    // transform, recovered from a frame on two reference vertices and checked on every vertex
+    struct PropFrame {
+        glm::vec3 centroid = glm::vec3(0.0f);
+        glm::mat3 basis = glm::mat3(1.0f);  // orthonormal, right-handed
+        float radius = 0.0f;                // distance of refA from the centroid
+        int refA = -1;
+        int refB = -1;
+    };
+
+    static glm::vec3 propCentroid(const std::vector<Vertex>& vertices)
+    {
+        glm::vec3 sum(0.0f);
+        for (const auto& v : vertices) sum += v.Position;
+        return sum / (float)vertices.size();
+    }
+
+    static glm::mat3 propBasis(const std::vector<Vertex>& vertices, const glm::vec3& centroid, int refA, int refB)
+    {
+        glm::vec3 e1 = glm::normalize(vertices[refA].Position - centroid);
+        glm::vec3 b = vertices[refB].Position - centroid;
+        glm::vec3 e2 = glm::normalize(b - glm::dot(b, e1) * e1);
+        return glm::mat3(e1, e2, glm::cross(e1, e2));
+    }
+
+    // refA: farthest vertex from the centroid, refB: farthest from the line through it;
+    // false for flat-to-a-line / degenerate submeshes (no unique rotation)
+    static bool computePropFrame(const std::vector<Vertex>& vertices, PropFrame& out)
+    {
+        if (vertices.size() < 3) return false;
+
+        out.centroid = propCentroid(vertices);
+        out.refA = 0;
+        float bestSq = -1.0f;
+        for (size_t i = 0; i < vertices.size(); i++) {
+            glm::vec3 d = vertices[i].Position - out.centroid;
+            if (glm::dot(d, d) > bestSq) { bestSq = glm::dot(d, d); out.refA = (int)i; }
+        }
+        out.radius = std::sqrt(bestSq);
+        if (out.radius <= 1e-6f) return false;
+
+        glm::vec3 axis = (vertices[out.refA].Position - out.centroid) / out.radius;
+        float bestCross = 0.0f;
+        for (size_t i = 0; i < vertices.size(); i++) {
+            float c = glm::length(glm::cross(axis, vertices[i].Position - out.centroid));
+            if (c > bestCross) { bestCross = c; out.refB = (int)i; }
+        }
+        if (out.refB < 0 || bestCross <= out.radius * 1e-3f) return false;
+
+        out.basis = propBasis(vertices, out.centroid, out.refA, out.refB);
+        return true;
+    }
+
+    static void hashCombine(size_t& h, size_t v)
+    {
+        h ^= v + (size_t)0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    }
+
+    // invariant under rigid transforms: topology, uvs and distances to the centroid (relative to
+    // the radius, coarsely rounded); equal hashes are only candidates, matchProp decides
+    static size_t propSignature(int matId, const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+        const PropFrame& frame)
+    {
+        size_t h = std::hash<int>()(matId);
+        hashCombine(h, vertices.size());
+        hashCombine(h, indices.size());
+        for (GLuint i : indices) hashCombine(h, i);
+
+        for (const auto& v : vertices) {
+            hashCombine(h, (size_t)std::lround(v.TexCoords.x * 1024.0f));
+            hashCombine(h, (size_t)std::lround(v.TexCoords.y * 1024.0f));
+            hashCombine(h, (size_t)std::lround(glm::length(v.Position - frame.centroid) / frame.radius * 64.0f));
+        }
+        return h;
+    }
+
+    // copy = R * prototype + t on every vertex (positions within tolerance * radius, rotated
+    // normals, equal uvs); outMatrix maps the prototype onto the copy
+    static bool matchProp(const std::vector<Vertex>& proto, const std::vector<GLuint>& protoIndices,
+        const PropFrame& protoFrame, const std::vector<Vertex>& copy, const std::vector<GLuint>& copyIndices,
+        float tolerance, glm::mat4& outMatrix)
+    {
+        if (proto.size() != copy.size() || protoIndices != copyIndices) return false;
+
+        glm::vec3 centroid = propCentroid(copy);
+        glm::vec3 a = copy[protoFrame.refA].Position - centroid;
+        glm::vec3 b = copy[protoFrame.refB].Position - centroid;
+        if (std::fabs(glm::length(a) - protoFrame.radius) > tolerance * protoFrame.radius) return false;
+        if (glm::length(glm::cross(a, b)) <= protoFrame.radius * 1e-3f * glm::length(a)) return false;
+
+        glm::mat3 R = propBasis(copy, centroid, protoFrame.refA, protoFrame.refB) * glm::transpose(protoFrame.basis);
+        glm::vec3 t = centroid - R * protoFrame.centroid;
+
+        float maxError = tolerance * protoFrame.radius;
+        for (size_t i = 0; i < proto.size(); i++) {
+            if (glm::length(R * proto[i].Position + t - copy[i].Position) > maxError) return false;
+            if (glm::length(R * proto[i].Normal - copy[i].Normal) > 1e-2f) return false;
+
+            glm::vec2 uv = glm::abs(proto[i].TexCoords - copy[i].TexCoords);
+            if (std::max(uv.x, uv.y) > 1e-4f) return false;
+        }
+
+        outMatrix = glm::mat4(R);
+        outMatrix[3] = glm::vec4(t, 1.0f);
+        return true;
     }
 
     // --- helper for collision grid keys
@@ -105,6 +832,8 @@ namespace gps {
 
     void Model3D::ReadOBJ(std::string fileName, std::string basePath)
     {
+        WT_PROFILE_FUNCTION();
+
         std::cout << "Loading : " << fileName << std::endl;
 
         tinyobj::attrib_t attrib;
@@ -116,26 +845,93 @@ namespace gps {
             fileName.c_str(), basePath.c_str(), GL_TRUE);
 
         if (!err.empty()) std::cerr << err << std::endl;
-        if (!ret) exit(1);
+        if (!ret) {
+            // exiting from here would run the destructors on this thread (join on itself, GL without a context)
+            std::cerr << "Failed to load " << fileName << std::endl;
+            std::lock_guard<std::mutex> lock(loadMutex);
+            loaderFailed = true;
+            loaderDone = true;
+            return;
+        }
 
         std::cout << "# of shapes    : " << shapes.size() << std::endl;
         std::cout << "# of materials : " << materials.size() << std::endl;
 
-        meshes.clear();
-        loadedTextures.clear();
         terrainTriangles.clear();
         sceneCollidersLocal.clear();
 
+        // lightbulb faces: OBJ position index -> union-find node (faces sharing a position are connected)
+        std::unordered_map<int, int> bulbNodeOfVertex;
+        std::vector<int> bulbParent;
+        std::vector<int> bulbVertexOfNode;
+        std::vector<int> bulbMatOfNode;
+
         // === NEW: collision grid (MODEL-LOCAL)
         // cell size in LOCAL units (model is huge before scaling)
         const float cellSize = 250.0f; // adjust if needed (200..500)
         std::unordered_map<long long, AABB> collisionCells;
 
+        size_t cornerCount = 0, weldedCount = 0;
+
+        auto isTerrainMaterial = [&](int matId) {
+            return matId >= 0 && matId < (int)materials.size() && isTerrainMaterialName(materials[matId].name);
+        };
+
+        // one Mesh (chunked) with the textures + Kd of its material
+        auto emitMesh = [&](int matId, const std::vector<gps::Vertex>& vertices, const std::vector<GLuint>& indices,
+            const std::vector<glm::mat4>& instances)
+        {
+            std::vector<gps::Texture> textures;
+            glm::vec3 kd(1.0f, 1.0f, 1.0f);
+
+            if (matId >= 0 && matId < (int)materials.size())
+            {
+                const auto& m = materials[matId];
+                kd = glm::vec3(m.diffuse[0], m.diffuse[1], m.diffuse[2]);
+
+                std::string diffuseTex = normalizeTexName(m.diffuse_texname);
+                if (!diffuseTex.empty()) {
+                    gps::Texture t = requestTexture(basePath + diffuseTex, "diffuseTexture");
+                    textures.push_back(t);
+                }
+
+                std::string specTex = normalizeTexName(m.specular_texname);
+                if (!specTex.empty()) {
+                    gps::Texture t = requestTexture(basePath + specTex, "specularTexture");
+                    textures.push_back(t);
+                }
+
+                std::string ambTex = normalizeTexName(m.ambient_texname);
+                if (!ambTex.empty()) {
+                    gps::Texture t = requestTexture(basePath + ambTex, "ambientTexture");
+                    textures.push_back(t);
+                }
+            }
+
+            // the ground stays geometry at any distance
+            addMeshChunks(vertices, indices, textures, kd, !isTerrainMaterial(matId), instances);
+            weldedCount += vertices.size();
+        };
+
+        // repeated props (kMinInstanceCount): grouped by a rigid-invariant signature
+        struct PropGroup {
+            int matId;
+            std::vector<gps::Vertex> vertices;      // the first copy (prototype)
+            std::vector<GLuint> indices;
+            PropFrame frame;
+            std::vector<glm::mat4> instances;       // prototype -> copy, identity first (no vertex copies kept)
+        };
+        std::vector<PropGroup> propGroups;
+        std::unordered_map<size_t, std::vector<int>> propGroupsBySignature;
+
         for (size_t s = 0; s < shapes.size(); s++)
         {
+            if (loadCancelled) return;
+
             struct SubMesh {
                 std::vector<gps::Vertex> vertices;
                 std::vector<GLuint> indices;
+                std::unordered_map<ObjIndexKey, GLuint, ObjIndexKeyHash> vertexOfCorner;
             };
 
             std::unordered_map<int, SubMesh> byMat;
@@ -156,8 +952,32 @@ namespace gps {
                 facePosLocal.reserve(fv);
 
                 bool faceIsTerrain = false;
+                bool faceIsBulb = false;
                 if (matId >= 0 && matId < (int)materials.size()) {
                     faceIsTerrain = isTerrainMaterialName(materials[matId].name);
+                    faceIsBulb = isLightbulbMaterialName(materials[matId].name);
+                }
+
+                if (faceIsBulb) {
+                    int firstNode = -1;
+                    for (int v = 0; v < fv; v++) {
+                        int vi = shapes[s].mesh.indices[index_offset + v].vertex_index;
+                        auto it = bulbNodeOfVertex.find(vi);
+                        int node;
+                        if (it == bulbNodeOfVertex.end()) {
+                            node = (int)bulbParent.size();
+                            bulbNodeOfVertex.emplace(vi, node);
+                            bulbParent.push_back(node);
+                            bulbVertexOfNode.push_back(vi);
+                            bulbMatOfNode.push_back(matId);
+                        }
+                        else {
+                            node = it->second;
+                        }
+
+                        if (firstNode < 0) firstNode = node;
+                        else unite(bulbParent, firstNode, node);
+                    }
                 }
 
                 for (int v = 0; v < fv; v++)
@@ -186,8 +1006,15 @@ namespace gps {
                     vert.Normal = glm::vec3(nx, ny, nz);
                     vert.TexCoords = glm::vec2(tx, ty);
 
-                    sm.vertices.push_back(vert);
-                    sm.indices.push_back((GLuint)(sm.vertices.size() - 1));
+                    // weld: the attributes come only from the OBJ indices, so equal keys are equal vertices
+                    ObjIndexKey key{ idx.vertex_index, idx.normal_index, idx.texcoord_index };
+                    auto welded = sm.vertexOfCorner.find(key);
+                    if (welded == sm.vertexOfCorner.end()) {
+                        welded = sm.vertexOfCorner.emplace(key, (GLuint)sm.vertices.size()).first;
+                        sm.vertices.push_back(vert);
+                    }
+                    sm.indices.push_back(welded->second);
+                    cornerCount++;
 
                     facePosLocal.push_back(vert.Position);
 
@@ -226,42 +1053,74 @@ namespace gps {
                 index_offset += fv;
             }
 
-            // build render meshes per material (unchanged for rendering)
+            // render meshes per material; props that may repeat wait for the end of the file
             for (auto& kv : byMat)
             {
                 int matId = kv.first;
                 SubMesh& sm = kv.second;
 
-                std::vector<gps::Texture> textures;
-                glm::vec3 kd(1.0f, 1.0f, 1.0f);
-
-                if (matId >= 0 && matId < (int)materials.size())
-                {
-                    const auto& m = materials[matId];
-                    kd = glm::vec3(m.diffuse[0], m.diffuse[1], m.diffuse[2]);
+                PropFrame frame;
+                if (isTerrainMaterial(matId) || !computePropFrame(sm.vertices, frame)) {
+                    emitMesh(matId, sm.vertices, sm.indices, {});
+                    continue;
+                }
 
-                    std::string diffuseTex = normalizeTexName(m.diffuse_texname);
-                    if (!diffuseTex.empty()) {
-                        gps::Texture t = LoadTexture(basePath + diffuseTex, "diffuseTexture");
-                        textures.push_back(t);
-                    }
+                std::vector<int>& candidates = propGroupsBySignature[propSignature(matId, sm.vertices, sm.indices, frame)];
 
-                    std::string specTex = normalizeTexName(m.specular_texname);
-                    if (!specTex.empty()) {
-                        gps::Texture t = LoadTexture(basePath + specTex, "specularTexture");
-                        textures.push_back(t);
-                    }
+                bool matched = false;
+                for (int g : candidates) {
+                    PropGroup& group = propGroups[g];
+                    glm::mat4 instance;
+                    if (group.matId != matId || !matchProp(group.vertices, group.indices, group.frame,
+                        sm.vertices, sm.indices, kInstanceTolerance, instance)) continue;
 
-                    std::string ambTex = normalizeTexName(m.ambient_texname);
-                    if (!ambTex.empty()) {
-                        gps::Texture t = LoadTexture(basePath + ambTex, "ambientTexture");
-                        textures.push_back(t);
-                    }
+                    group.instances.push_back(instance);
+                    matched = true;
+                    break;
                 }
+                if (matched) continue;
+
+                candidates.push_back((int)propGroups.size());
+                propGroups.push_back({ matId, std::move(sm.vertices), std::move(sm.indices), frame, { glm::mat4(1.0f) } });
+            }
+        }
 
-                meshes.push_back(gps::Mesh(sm.vertices, sm.indices, textures, kd));
+        // props: one instanced Mesh when there are enough copies, else one Mesh per copy
+        size_t instancedMeshes = 0, instancedCopies = 0, sharedVertices = 0;
+        for (const auto& group : propGroups) {
+            if (loadCancelled) return;
+
+            if (group.instances.size() >= kMinInstanceCount) {
+                emitMesh(group.matId, group.vertices, group.indices, group.instances);
+                instancedMeshes++;
+                instancedCopies += group.instances.size();
+                sharedVertices += (group.instances.size() - 1) * group.vertices.size();
+                continue;
+            }
+
+            // the copies are rebuilt from the prototype: they matched it within kInstanceTolerance,
+            // the same error an instanced draw would have
+            emitMesh(group.matId, group.vertices, group.indices, {});
+
+            std::vector<gps::Vertex> copy = group.vertices;
+            for (size_t i = 1; i < group.instances.size(); i++) {
+                const glm::mat4& instance = group.instances[i];
+                glm::mat3 rotation(instance);
+                for (size_t v = 0; v < copy.size(); v++) {
+                    copy[v].Position = glm::vec3(instance * glm::vec4(group.vertices[v].Position, 1.0f));
+                    copy[v].Normal = rotation * group.vertices[v].Normal;
+                }
+                emitMesh(group.matId, copy, group.indices, {});
             }
         }
+        std::cout << "Instanced props: " << instancedMeshes << " meshes for " << instancedCopies << " copies, "
+            << sharedVertices << " vertices not duplicated" << std::endl;
+        propGroups.clear();
+
+        std::cout << "Welded: " << cornerCount << " corners -> " << weldedCount << " vertices" << std::endl;
+
+        std::vector<PointLight> lights;
+        buildEmissiveLights(attrib, materials, bulbParent, bulbVertexOfNode, bulbMatOfNode, lights);
 
         // finalize colliders from grid
         sceneCollidersLocal.reserve(collisionCells.size());
@@ -271,11 +1130,154 @@ namespace gps {
 
         std::cout << "Terrain triangles: " << terrainTriangles.size() << std::endl;
         std::cout << "Scene colliders (grid AABB): " << sceneCollidersLocal.size() << std::endl;
+        collisionReady.store(true, std::memory_order_release);
+
+        // the depth stream, clusters and lights are built by finalizeGeometry on the GL thread
+        std::lock_guard<std::mutex> lock(loadMutex);
+        pendingEmissiveLights = std::move(lights);
+        loaderDone = true;
+    }
+
+    void Model3D::buildClusters(const std::vector<bool>& clusterable)
+    {
+        clusters.clear();
+        clusterOfMesh.assign(meshes.size(), -1);
+        meshFade.assign(meshes.size(), 0.0f);
+
+        std::unordered_map<long long, int> clusterOfCell;
+        size_t wideMeshes = 0;
+
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (!clusterable[i]) continue;
+
+            const AABB& b = meshBounds[i];
+            glm::vec3 size = b.maxP - b.minP;
+            if (std::max(size.x, size.z) > kClusterCellSize) {
+                wideMeshes++;
+                continue;
+            }
+
+            glm::vec3 center = 0.5f * (b.minP + b.maxP);
+            long long key = packKey((int)std::floor(center.x / kClusterCellSize), (int)std::floor(center.z / kClusterCellSize));
+
+            auto it = clusterOfCell.find(key);
+            if (it == clusterOfCell.end()) {
+                it = clusterOfCell.emplace(key, (int)clusters.size()).first;
+                clusters.push_back({ b.minP, b.maxP, {} });
+            }
+
+            MeshCluster& cluster = clusters[it->second];
+            cluster.boundsMin = vmin3(cluster.boundsMin, b.minP);
+            cluster.boundsMax = vmax3(cluster.boundsMax, b.maxP);
+            cluster.meshes.push_back((int)i);
+            clusterOfMesh[i] = it->second;
+        }
+
+        size_t clustered = 0;
+        for (const auto& c : clusters) clustered += c.meshes.size();
+        std::cout << "Impostor clusters: " << clusters.size() << " (" << clustered << " meshes, "
+            << wideMeshes << " wider than a cell stay geometry)" << std::endl;
+    }
+
+    void Model3D::buildEmissiveLights(const tinyobj::attrib_t& attrib,
+        const std::vector<tinyobj::material_t>& materials,
+        std::vector<int>& bulbParent,
+        const std::vector<int>& bulbVertexOfNode,
+        const std::vector<int>& bulbMatOfNode,
+        std::vector<PointLight>& outLights) const
+    {
+        // 1) centroid of every connected component (unique positions), in order of the first
+        //    node of each component: the merge below then does not depend on hash order
+        struct Component {
+            glm::vec3 sum = glm::vec3(0.0f);
+            int count = 0;
+            int matId = -1;
+        };
+        std::vector<Component> components;
+        std::unordered_map<int, int> componentOfRoot;
+
+        for (int node = 0; node < (int)bulbParent.size(); node++) {
+            int vi = bulbVertexOfNode[node];
+            glm::vec3 p(attrib.vertices[3 * vi + 0], attrib.vertices[3 * vi + 1], attrib.vertices[3 * vi + 2]);
+
+            auto it = componentOfRoot.emplace(findRoot(bulbParent, node), (int)components.size()).first;
+            if (it->second == (int)components.size()) components.push_back(Component());
+
+            Component& c = components[it->second];
+            c.sum += p;
+            c.count++;
+            c.matId = bulbMatOfNode[node];
+        }
+
+        // 2) merge pieces of the same bulb that are not topologically connected; lights are
+        //    kept on an XZ grid of mergeDist cells, so only the 3x3 cells around a piece can
+        //    hold a light close enough
+        const float mergeDist = 5.0f; // LOCAL units
+        std::vector<glm::vec3> centroids;
+        std::vector<int> weights;
+        std::vector<long long> cellOfLight;
+        std::unordered_map<long long, std::vector<int>> lightsInCell;
+        size_t firstLight = outLights.size();
+
+        auto cellX = [&](const glm::vec3& p) { return (int)std::floor(p.x / mergeDist); };
+        auto cellZ = [&](const glm::vec3& p) { return (int)std::floor(p.z / mergeDist); };
+
+        for (const Component& c : components) {
+            glm::vec3 centroid = c.sum / (float)c.count;
+
+            // the oldest light in range, as a scan over all lights would find it
+            int target = -1;
+            for (int dz = -1; dz <= 1; dz++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    auto cell = lightsInCell.find(packKey(cellX(centroid) + dx, cellZ(centroid) + dz));
+                    if (cell == lightsInCell.end()) continue;
+
+                    for (int i : cell->second) {
+                        if ((target < 0 || i < target) && glm::length(centroids[i] - centroid) < mergeDist) target = i;
+                    }
+                }
+            }
+
+            if (target >= 0) {
+                float w = (float)weights[target];
+                centroids[target] = (centroids[target] * w + centroid * (float)c.count) / (w + (float)c.count);
+                weights[target] += c.count;
+                outLights[firstLight + target].position = centroids[target];
+
+                // the merged centroid may have crossed into another cell
+                long long key = packKey(cellX(centroids[target]), cellZ(centroids[target]));
+                if (key != cellOfLight[target]) {
+                    std::vector<int>& old = lightsInCell[cellOfLight[target]];
+                    old.erase(std::find(old.begin(), old.end(), target));
+                    lightsInCell[key].push_back(target);
+                    cellOfLight[target] = key;
+                }
+                continue;
+            }
+
+            // colour: Kd tinted by Ka (the bulb material is Kd yellow, Ka orange)
+            glm::vec3 color(1.0f, 0.85f, 0.45f);
+            if (c.matId >= 0 && c.matId < (int)materials.size()) {
+                const auto& m = materials[c.matId];
+                glm::vec3 kd(m.diffuse[0], m.diffuse[1], m.diffuse[2]);
+                glm::vec3 ka(m.ambient[0], m.ambient[1], m.ambient[2]);
+                color = (ka == glm::vec3(0.0f)) ? kd : (ka + kd) * 0.5f;
+            }
+
+            long long key = packKey(cellX(centroid), cellZ(centroid));
+            lightsInCell[key].push_back((int)centroids.size());
+            cellOfLight.push_back(key);
+            centroids.push_back(centroid);
+            weights.push_back(c.count);
+            outLights.push_back({ centroid, color, 0.0f });
+        }
+
+        std::cout << "Emissive lights (lightbulb): " << outLights.size() << std::endl;
     }
 
     bool Model3D::getGroundHeightAtWorldXZ(const glm::mat4& modelMatrix, float worldX, float worldZ, float& outY) const
     {
-        if (terrainTriangles.empty()) return false;
+        if (!collisionReady.load(std::memory_order_acquire) || terrainTriangles.empty()) return false;
 
         glm::mat4 invM = glm::inverse(modelMatrix);
 
@@ -313,7 +1315,9 @@ namespace gps {
     // push sphere out of colliders
     bool Model3D::resolveSphereCollisions(const glm::mat4& modelMatrix, glm::vec3& inOutWorldPos, float radius) const
     {
-        if (sceneCollidersLocal.empty()) return false;
+        WT_PROFILE_FUNCTION();
+
+        if (!collisionReady.load(std::memory_order_acquire) || sceneCollidersLocal.empty()) return false;
 
         bool changed = false;
 
@@ -363,66 +1367,93 @@ namespace gps {
         return changed;
     }
 
-    gps::Texture Model3D::LoadTexture(std::string path, std::string type)
+    // loader thread: the GL id is filled in on the GL thread (uploadMesh / uploadTexture)
+    gps::Texture Model3D::requestTexture(const std::string& path, const std::string& type)
     {
-        for (int i = 0; i < (int)loadedTextures.size(); i++) {
-            if (loadedTextures[i].path == path) {
-                return loadedTextures[i];
-            }
-        }
+        gps::Texture texture;
+        texture.type = type;
+        texture.path = path;
 
-        gps::Texture currentTexture;
-        currentTexture.id = ReadTextureFromFile(path.c_str());
-        currentTexture.type = type;
-        currentTexture.path = path;
+        if (std::find(requestedTextures.begin(), requestedTextures.end(), path) != requestedTextures.end()) return texture;
+        requestedTextures.push_back(path);
+        texturesPending++;
 
-        loadedTextures.push_back(currentTexture);
-        return currentTexture;
+        if (jobs) jobs->runBackground([this, path]() { decodeTexture(path); });
+        else decodeTexture(path);
+        return texture;
     }
 
-    GLuint Model3D::ReadTextureFromFile(const char* file_name)
+    // any thread: file -> RGBA8, bottom row first, queued for uploadTexture
+    void Model3D::decodeTexture(const std::string& path)
     {
-        int x, y, n;
+        WT_PROFILE_FUNCTION();
+
+        DecodedTexture decoded;
+        decoded.path = path;
+
+        int x = 0, y = 0, n = 0;
         int force_channels = 4;
-        unsigned char* image_data = stbi_load(file_name, &x, &y, &n, force_channels);
-
-        if (!image_data) {
-            fprintf(stderr, "ERROR: could not load %s\n", file_name);
-            return 0;
-        }
-
-        int width_in_bytes = x * 4;
-        int half_height = y / 2;
-        for (int row = 0; row < half_height; row++) {
-            unsigned char* top = image_data + row * width_in_bytes;
-            unsigned char* bottom = image_data + (y - row - 1) * width_in_bytes;
-            for (int col = 0; col < width_in_bytes; col++) {
-                unsigned char temp = top[col];
-                top[col] = bottom[col];
-                bottom[col] = temp;
+        unsigned char* image_data = loadCancelled ? nullptr : stbi_load(path.c_str(), &x, &y, &n, force_channels);
+
+        if (image_data) {
+            decoded.width = x;
+            decoded.height = y;
+            decoded.pixels.resize((size_t)x * y * 4);
+
+            size_t width_in_bytes = (size_t)x * 4;
+            for (int row = 0; row < y; row++) {
+                std::memcpy(decoded.pixels.data() + row * width_in_bytes,
+                    image_data + (size_t)(y - row - 1) * width_in_bytes, width_in_bytes);
             }
+            stbi_image_free(image_data);
+        }
+        else if (!loadCancelled) {
+            fprintf(stderr, "ERROR: could not load %s\n", path.c_str());
         }
 
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        std::lock_guard<std::mutex> lock(loadMutex);
+        decodedTextures.push_back(std::move(decoded));
+    }
+
+    void Model3D::uploadTexture(const DecodedTexture& decoded)
+    {
+        WT_PROFILE_FUNCTION();
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, x, y, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        gps::Texture texture;
+        texture.path = decoded.path;
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (!decoded.pixels.empty()) {
+            glGenTextures(1, &texture.id);
+            glBindTexture(GL_TEXTURE_2D, texture.id);
 
-        glBindTexture(GL_TEXTURE_2D, 0);
-        stbi_image_free(image_data);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB, decoded.width, decoded.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded.pixels.data());
+            glGenerateMipmap(GL_TEXTURE_2D);
 
-        return textureID;
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+        loadedTextures.push_back(texture);
+
+        // meshes uploaded before the decode finished sample the placeholder until now
+        // (id 0 for an unreadable file: the mesh falls back to its Kd, as before)
+        for (auto& mesh : meshes) {
+            for (auto& t : mesh.textures) {
+                if (t.path == decoded.path) t.id = texture.id;
+            }
+        }
+
+        texturesPending--;
     }
 
     Model3D::~Model3D()
     {
+        cancelLoad();
+        if (placeholderTexture) glDeleteTextures(1, &placeholderTexture);
+
         for (size_t i = 0; i < loadedTextures.size(); i++) {
             glDeleteTextures(1, &loadedTextures.at(i).id);
         }
@@ -434,6 +1465,15 @@ namespace gps {
             glDeleteBuffers(1, &VBO);
             glDeleteBuffers(1, &EBO);
             glDeleteVertexArrays(1, &VAO);
+
+            GLuint instanceVBO = meshes.at(i).getInstanceBuffer();
+            if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
         }
+
+        if (depthStream.instanceVBO) glDeleteBuffers(1, &depthStream.instanceVBO);
+        if (depthStream.instancedVAO) glDeleteVertexArrays(1, &depthStream.instancedVAO);
+        if (depthStream.VBO) glDeleteBuffers(1, &depthStream.VBO);
+        if (depthStream.EBO) glDeleteBuffers(1, &depthStream.EBO);
+        if (depthStream.VAO) glDeleteVertexArrays(1, &depthStream.VAO);
     }
 }
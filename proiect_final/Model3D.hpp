@@ -2,35 +2,133 @@
 #define Model3D_hpp
 
 #include "Mesh.hpp"
+#include "ClusteredLights.hpp"
 
 #include "tiny_obj_loader.h"
 #include "stb_image.h"
 
+#include <atomic>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace gps {
 
+    class JobSystem;
+
     class Model3D {
 
     public:
         ~Model3D();
 
+        // GPU vertex layout of the meshes; set before LoadModel
+        void setVertexFormat(VertexFormat format) { vertexFormat = format; }
+        // per-mesh selection (selectLods, cullBeyond) is split over it; null: calling thread only
+        void setJobSystem(JobSystem* jobs) { this->jobs = jobs; }
+
+        // blocking: returns with every mesh and texture on the GPU
         void LoadModel(std::string fileName);
         void LoadModel(std::string fileName, std::string basePath);
+
+        // Progressive loading: the OBJ is parsed (welding, instanced props, LODs, colliders) on a
+        // background thread and the texture files are decoded on the job system; pumpUploads turns
+        // what is ready into GL objects on the GL thread. Meshes are drawn as soon as they are
+        // uploaded and sample a 1x1 placeholder until their textures arrive. The shared depth
+        // stream (DrawDepth, DrawDepthSorted), the impostor clusters and the emissive lights exist
+        // once isGeometryComplete(); terrain height and collisions answer false until then.
+        void LoadModelAsync(std::string fileName);
+        // GL thread, once per frame: uploads for at most ~budgetMs (<= 0: everything ready now),
+        // at least one item per call. True once loading is over: every mesh and texture is on the
+        // GPU (isLoaded) or the OBJ could not be read (hasLoadFailed, nothing is drawn).
+        bool pumpUploads(double budgetMs);
+        bool isGeometryComplete() const { return geometryComplete; }
+        bool isLoaded() const { return loaded; }
+        bool hasLoadFailed() const { return loadFailed; }
+        size_t getMeshCount() const { return meshes.size(); }
+        // stops the loader thread (between shapes) and waits for it; before the job system goes away
+        void cancelLoad();
+
         void Draw(gps::Shader shaderProgram);
 
+        // Depth-only submission (shadow pass / depth pre-pass): positions only, no material state.
+        // The caller binds the program and sets its uniforms.
+        void DrawDepth();
+        // Same, one draw per mesh ordered front-to-back from eyeLocal (MODEL-LOCAL camera position).
+        // With VERTEX_PACKED it draws the meshes' own packed buffers (the program must be built
+        // with PACKED_VERTICES), so the depth matches the main pass exactly under GL_EQUAL.
+        void DrawDepthSorted(const glm::vec3& eyeLocal);
+
+        // Level of detail per mesh (main, pre-pass and shadow draws): the coarsest LOD whose
+        // geometric error, projected at the mesh's closest point, stays under maxErrorPx.
+        // pixelsPerUnit = viewportHeight / (2 tan(fovy / 2)); maxErrorPx <= 0 forces LOD 0.
+        void selectLods(const glm::vec3& eyeLocal, float pixelsPerUnit, float maxErrorPx);
+
+        // Distance culling (fog): meshes whose closest point is farther than maxDistance
+        // (MODEL-LOCAL units) from eyeLocal are skipped by Draw, DrawFading and DrawDepthSorted.
+        // DrawDepth (shadows) keeps them, they can still shadow what is visible.
+        // maxDistance <= 0 disables it.
+        void cullBeyond(const glm::vec3& eyeLocal, float maxDistance);
+
+        // LOD chain built at load time: each level keeps ~kLodRatio of the previous one's triangles
+        static constexpr int kMaxLods = 4;
+        static constexpr float kLodRatio = 0.5f;
+        static constexpr size_t kLodMinTriangles = 64;
+        // meshes per job in selectLods / cullBeyond
+        static constexpr size_t kJobGrainMeshes = 256;
+
+        // Repeated props (lamp posts, antennas, signs): per-material submeshes equal up to a rigid
+        // transform become one instanced Mesh once at least kMinInstanceCount copies are found;
+        // fewer copies stay separate meshes (they cull and pick LODs better one by one)
+        static constexpr size_t kMinInstanceCount = 4;
+        static constexpr float kInstanceTolerance = 1e-3f;   // position error / prop radius
+
+        // Impostor clusters: non-terrain meshes grouped at load time on a MODEL-LOCAL XZ grid
+        // (a mesh joins the cell of its bounds centre; meshes wider than a cell stay geometry)
+        struct MeshCluster {
+            glm::vec3 boundsMin;
+            glm::vec3 boundsMax;
+            std::vector<int> meshes;
+        };
+        static constexpr float kClusterCellSize = 400.0f;
+
+        const std::vector<MeshCluster>& getClusters() const { return clusters; }
+        // LOD 0 of one cluster with its material state (impostor baking)
+        void DrawCluster(int cluster, gps::Shader shaderProgram);
+
+        // Hand-off to the impostors, one value per cluster: 0 = geometry, 1 = impostor only,
+        // in between = cross-fade. Draw and DrawDepthSorted skip every mesh of a cluster with
+        // fade > 0; DrawFading draws the cross-fading ones (program built with LOD_FADE).
+        // DrawDepth (shadows) keeps every mesh.
+        void setClusterFades(const std::vector<float>& fades);
+        void DrawFading(gps::Shader shaderProgram);
+
         // Uneven terrain support
         bool getGroundHeightAtWorldXZ(const glm::mat4& modelMatrix, float worldX, float worldZ, float& outY) const;
 
         // Collisions with scene objects (buildings etc.)
         bool resolveSphereCollisions(const glm::mat4& modelMatrix, glm::vec3& inOutWorldPos, float radius) const;
 
+        // Point lights found at load time on *lightbulb* materials (one per connected bulb),
+        // positions in MODEL-LOCAL coordinates, radius left at 0 for the caller to choose
+        const std::vector<PointLight>& getEmissiveLights() const { return emissiveLightsLocal; }
+
     private:
         std::vector<gps::Mesh> meshes;
         std::vector<gps::Texture> loadedTextures;
 
+        VertexFormat vertexFormat = VERTEX_FLOAT;
+        JobSystem* jobs = nullptr;
+
+        // Scene bounds per mesh, MODEL-LOCAL (instanced: union over the copies)
+        struct AABB {
+            glm::vec3 minP;
+            glm::vec3 maxP;
+        };
+        std::vector<AABB> meshBounds;
+
         // Terrain triangles stored in MODEL-LOCAL coordinates
         struct Triangle {
             glm::vec3 a;
@@ -40,15 +138,117 @@ namespace gps {
         std::vector<Triangle> terrainTriangles;
 
         // Scene colliders stored in MODEL-LOCAL coordinates
-        struct AABB {
-            glm::vec3 minP;
-            glm::vec3 maxP;
-        };
         std::vector<AABB> sceneCollidersLocal;
+        // set by the loader once terrainTriangles + sceneCollidersLocal are final (read-only after)
+        std::atomic<bool> collisionReady{ false };
+
+        std::vector<PointLight> emissiveLightsLocal;
+
+        std::vector<MeshCluster> clusters;
+        std::vector<bool> clusterableMeshes;    // per mesh: may be replaced by an impostor
+        std::vector<int> clusterOfMesh;     // -1: not part of any cluster
+        std::vector<float> meshFade;        // fade of the mesh's cluster (0 when none)
+        std::vector<unsigned char> meshCulled;  // beyond the cullBeyond distance (bytes, not bits: set from jobs)
+
+        // All meshes merged into one tightly packed position buffer (vec3). Indices stay local to
+        // each mesh (16-bit when every mesh allows it) and are drawn with a base vertex.
+        // Instanced meshes are stored once; their matrices live in instanceVBO.
+        struct DepthRange {
+            GLsizei firstIndex;
+            GLsizei indexCount;
+            GLint baseVertex;
+            size_t instanceOffset;      // bytes into instanceVBO (instanced meshes)
+        };
+        struct DepthStream {
+            GLuint VAO = 0;
+            GLuint VBO = 0;
+            GLuint EBO = 0;
+            GLenum indexType = GL_UNSIGNED_INT;
+            GLsizei indexCount = 0;
+            std::vector<DepthRange> ranges; // one per mesh
+
+            // instanced meshes: same VBO / EBO, instance matrices re-pointed per draw
+            GLuint instancedVAO = 0;
+            GLuint instanceVBO = 0;
+            std::vector<int> instancedMeshes;
+
+            // DrawDepth: every range in one glMultiDrawElementsBaseVertex (instanced ones have count 0)
+            std::vector<GLsizei> counts;
+            std::vector<const GLvoid*> offsets;
+            std::vector<GLint> baseVertices;
+            GLsizei selectedIndexCount = 0;
+        };
+        DepthStream depthStream;
+
+        // scratch for DrawDepthSorted (reused every frame)
+        std::vector<std::pair<float, int>> depthOrder;
+
+        // --- progressive loading: loader thread -> GL thread
+        struct PendingMesh {
+            std::vector<Vertex> vertices;
+            std::vector<GLuint> indices;        // every LOD, back to back
+            std::vector<MeshLod> lods;
+            std::vector<Texture> textures;      // ids resolved on the GL thread
+            glm::vec3 kd;
+            std::vector<glm::mat4> instances;
+            bool clusterable;
+        };
+        struct DecodedTexture {
+            std::string path;
+            int width = 0;
+            int height = 0;
+            std::vector<unsigned char> pixels;  // RGBA8, bottom row first; empty: unreadable file
+        };
+
+        std::thread loader;
+        std::atomic<bool> loadCancelled{ false };
+        std::mutex loadMutex;                   // guards the five members below
+        std::vector<PendingMesh> pendingMeshes;
+        std::vector<DecodedTexture> decodedTextures;
+        std::vector<PointLight> pendingEmissiveLights;
+        bool loaderDone = false;
+        bool loaderFailed = false;              // unreadable OBJ: reported on the GL thread
+        std::atomic<int> texturesPending{ 0 };  // requested, not uploaded yet
+
+        std::vector<std::string> requestedTextures;     // loader thread only
+
+        // GL thread only
+        std::deque<PendingMesh> meshUploads;
+        std::deque<DecodedTexture> textureUploads;
+        GLuint placeholderTexture = 0;
+        bool geometryComplete = false;
+        bool loaded = false;
+        bool loadFailed = false;
+
+        void startLoad(std::string fileName, std::string basePath);
+        void uploadMesh(PendingMesh& pending);
+        void uploadTexture(const DecodedTexture& decoded);
+        void finalizeGeometry();
+        gps::Texture requestTexture(const std::string& path, const std::string& type);
+        void decodeTexture(const std::string& path);
+
+        void setupDepthStream();
+        void updateDepthDraws();
+        void drawDepthInstanced(int mesh) const;
+        void buildClusters(const std::vector<bool>& clusterable);
+        void reportMeshBuffers() const;
+        void buildLods(const std::vector<Vertex>& vertices, std::vector<GLuint>& inOutIndices,
+            std::vector<MeshLod>& outLods) const;
+        void addMesh(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+            const std::vector<Texture>& textures, const glm::vec3& kd, bool clusterable,
+            const std::vector<glm::mat4>& instances = {});
+        void addMeshChunks(const std::vector<Vertex>& vertices, const std::vector<GLuint>& indices,
+            const std::vector<Texture>& textures, const glm::vec3& kd, bool clusterable,
+            const std::vector<glm::mat4>& instances = {});
+        void buildEmissiveLights(const tinyobj::attrib_t& attrib,
+            const std::vector<tinyobj::material_t>& materials,
+            std::vector<int>& bulbParent,
+            const std::vector<int>& bulbVertexOfNode,
+            const std::vector<int>& bulbMatOfNode,
+            std::vector<PointLight>& outLights) const;
 
+        // loader thread: everything CPU-side, meshes handed over through pendingMeshes
         void ReadOBJ(std::string fileName, std::string basePath);
-        gps::Texture LoadTexture(std::string path, std::string type);
-        GLuint ReadTextureFromFile(const char* file_name);
 
         // Ray-triangle (Moller-Trumbore)
         static bool rayTriangleIntersect(const glm::vec3& orig, const glm::vec3& dir,
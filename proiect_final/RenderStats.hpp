@@ -0,0 +1,36 @@
+#ifndef RenderStats_hpp
+#define RenderStats_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+namespace gps {
+
+    // Draw calls / triangles submitted during the current frame (benchmark report).
+    // Every glDraw* site adds to it; the application resets it at the start of each frame.
+    struct RenderStats {
+        unsigned long long drawCalls = 0;
+        unsigned long long triangles = 0;
+
+        void reset()
+        {
+            drawCalls = 0;
+            triangles = 0;
+        }
+
+        void addDraw(GLsizei vertexCount)
+        {
+            drawCalls++;
+            triangles += (unsigned long long)(vertexCount / 3);
+        }
+    };
+
+    inline RenderStats renderStats;
+}
+
+#endif /* RenderStats_hpp */
@@ -8,9 +8,27 @@
 
 #include "Shader.hpp"
 
+#include <algorithm>
+#include <filesystem>
+
 namespace gps {
     std::string Shader::readShaderFile(std::string fileName) {
 
+        std::vector<std::string> includeStack;
+        return readShaderFile(fileName, includeStack);
+    }
+
+    std::string Shader::readShaderFile(std::string fileName, std::vector<std::string>& includeStack) {
+
+        //a file that is still being expanded would include itself forever
+        std::string path = std::filesystem::path(fileName).lexically_normal().generic_string();
+        if (std::find(includeStack.begin(), includeStack.end(), path) != includeStack.end()) {
+            std::cout << "Shader include cycle: ";
+            for (const std::string& file : includeStack) std::cout << file << " -> ";
+            std::cout << path << std::endl;
+            return "";
+        }
+
         std::ifstream shaderFile;
         std::string shaderString;
         
@@ -27,9 +45,53 @@ namespace gps {
         
         //convert stream into GLchar array
         shaderString = shaderStringStream.str();
-        return shaderString;
+
+        includeStack.push_back(path);
+        std::string resolved = resolveIncludes(shaderString, fileName, includeStack);
+        includeStack.pop_back();
+        return resolved;
+    }
+
+    std::string Shader::resolveIncludes(const std::string& source, const std::string& fileName,
+        std::vector<std::string>& includeStack) {
+
+        //#include "file" is resolved relative to the including shader (GLSL has no includes)
+        std::string directory;
+        size_t slash = fileName.find_last_of("/\\");
+        if (slash != std::string::npos) directory = fileName.substr(0, slash + 1);
+
+        std::stringstream in(source);
+        std::string result;
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t directive = line.find("#include");
+            size_t open = line.find('"');
+            size_t close = (open == std::string::npos) ? std::string::npos : line.find('"', open + 1);
+
+            if (directive != std::string::npos && close != std::string::npos &&
+                line.find_first_not_of(" \t") == directive) {
+                result += readShaderFile(directory + line.substr(open + 1, close - open - 1), includeStack);
+                result += "\n";
+            }
+            else {
+                result += line + "\n";
+            }
+        }
+        return result;
     }
     
+    std::string Shader::injectDefines(std::string source, const std::string& defines) {
+
+        if (defines.empty()) return source;
+
+        //#version must stay the first line, so the defines go right after it
+        size_t versionPos = source.find("#version");
+        size_t lineEnd = (versionPos == std::string::npos) ? std::string::npos : source.find('\n', versionPos);
+        if (lineEnd == std::string::npos) return defines + "\n" + source;
+
+        return source.substr(0, lineEnd + 1) + defines + "\n" + source.substr(lineEnd + 1);
+    }
+
     void Shader::shaderCompileLog(GLuint shaderId) {
 
         GLint success;
@@ -60,8 +122,13 @@ namespace gps {
     
     void Shader::loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName) {
 
+        loadShader(vertexShaderFileName, fragmentShaderFileName, "");
+    }
+
+    void Shader::loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName, std::string defines) {
+
         //read, parse and compile the vertex shader
-        std::string v = readShaderFile(vertexShaderFileName);
+        std::string v = injectDefines(readShaderFile(vertexShaderFileName), defines);
         const GLchar* vertexShaderString = v.c_str();
         GLuint vertexShader;
         vertexShader = glCreateShader(GL_VERTEX_SHADER);
@@ -71,7 +138,7 @@ namespace gps {
         shaderCompileLog(vertexShader);
         
         //read, parse and compile the vertex shader
-        std::string f = readShaderFile(fragmentShaderFileName);
+        std::string f = injectDefines(readShaderFile(fragmentShaderFileName), defines);
         const GLchar* fragmentShaderString = f.c_str();
         GLuint fragmentShader;
         fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
@@ -19,6 +19,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 
 namespace gps {
@@ -28,10 +29,17 @@ namespace gps {
     public:
         GLuint shaderProgram;
         void loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName);
+        // same as above, with extra #define lines injected right after #version (shader permutations)
+        void loadShader(std::string vertexShaderFileName, std::string fragmentShaderFileName, std::string defines);
         void useShaderProgram();
     
     private:
         std::string readShaderFile(std::string fileName);
+        // includeStack: the files being expanded right now, outermost first (cycle detection)
+        std::string readShaderFile(std::string fileName, std::vector<std::string>& includeStack);
+        std::string resolveIncludes(const std::string& source, const std::string& fileName,
+            std::vector<std::string>& includeStack);
+        std::string injectDefines(std::string source, const std::string& defines);
         void shaderCompileLog(GLuint shaderId);
         void shaderLinkLog(GLuint shaderProgramId);
     };
@@ -16,11 +16,11 @@ namespace gps {
     public:
         SkyBox();
         void Load(std::vector<const GLchar*> cubeMapFaces);
-        void Draw(gps::Shader shader, glm::mat4 viewMatrix, glm::mat4 projectionMatrix);
+        // view directions come from the CameraBlock uniform buffer (invView, invProjection)
+        void Draw(gps::Shader shader);
         GLuint GetTextureId();
     private:
         GLuint skyboxVAO;
-        GLuint skyboxVBO;
         GLuint cubemapTexture;
         GLuint LoadSkyBoxTextures(std::vector<const GLchar*> cubeMapFaces);
         void InitSkyBox();
@@ -0,0 +1,173 @@
+#include "StreamBuffer.hpp"
+#include "CpuProfiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace gps {
+
+    static const GLuint64 kStallPollNs = 1000000;  // 1 ms per glClientWaitSync while stalled
+
+    StreamBuffer::~StreamBuffer()
+    {
+        release();
+    }
+
+    void StreamBuffer::release()
+    {
+        for (auto& fence : fences) glDeleteSync(fence.sync);
+        fences.clear();
+
+        // deleting a buffer also unmaps it
+        if (buffer) glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        mapped = nullptr;
+        size = 0;
+        head = frameStart = retired = 0;
+    }
+
+    void StreamBuffer::create(GLsizeiptr size, bool allowPersistent)
+    {
+        release();
+        this->size = size;
+
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+#if !defined (__APPLE__)
+        if (allowPersistent && GLEW_ARB_buffer_storage) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+
+            // immutable storage cannot be re-specified: start over with a plain buffer
+            if (!mapped) {
+                glDeleteBuffers(1, &buffer);
+                glGenBuffers(1, &buffer);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            }
+        }
+#endif
+
+        if (!mapped) glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void StreamBuffer::beginFrame()
+    {
+        if (!buffer) return;
+
+        stats.lastFrameBytes = (GLsizeiptr)(head - frameStart);
+        stats.peakFrameBytes = std::max(stats.peakFrameBytes, stats.lastFrameBytes);
+
+        // every command reading last frame's allocations was issued before this fence
+        if (head > frameStart) fences.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), head });
+        frameStart = head;
+
+        // drop whatever the GPU already finished, without waiting
+        while (!fences.empty()) {
+            GLenum status = glClientWaitSync(fences.front().sync, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) break;
+
+            retired = fences.front().end;
+            glDeleteSync(fences.front().sync);
+            fences.pop_front();
+        }
+    }
+
+    void StreamBuffer::waitForRetired(unsigned long long position)
+    {
+        // the oldest fence covering position; the older ones are done once it is
+        auto covering = std::find_if(fences.begin(), fences.end(),
+            [position](const Fence& fence) { return fence.end >= position; });
+        if (covering == fences.end()) return;
+
+        GLenum status = glClientWaitSync(covering->sync, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            WT_PROFILE_SCOPE("StreamBuffer stall");
+
+            auto t0 = std::chrono::steady_clock::now();
+            do {
+                status = glClientWaitSync(covering->sync, GL_SYNC_FLUSH_COMMANDS_BIT, kStallPollNs);
+            } while (status == GL_TIMEOUT_EXPIRED);
+            auto t1 = std::chrono::steady_clock::now();
+
+            stats.stalls++;
+            stats.stallMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        }
+
+        retired = covering->end;
+        for (auto it = fences.begin(); it != covering + 1; ++it) glDeleteSync(it->sync);
+        fences.erase(fences.begin(), covering + 1);
+    }
+
+    StreamBuffer::Placement StreamBuffer::place(unsigned long long head, GLsizeiptr size, GLsizeiptr bytes,
+        GLsizeiptr alignment)
+    {
+        Placement placement;
+        placement.start = head;
+        placement.offset = (GLsizeiptr)(head % (unsigned long long)size);
+        if (alignment > 1 && placement.offset % alignment != 0) {
+            GLsizeiptr padding = alignment - placement.offset % alignment;
+            placement.start += padding;
+            placement.offset += padding;
+        }
+
+        // never split an allocation across the end of the buffer
+        placement.wrapped = placement.offset + bytes > size;
+        if (placement.wrapped) {
+            placement.start = placement.start - placement.offset + size;   // first position of the next lap
+            placement.offset = 0;
+        }
+        return placement;
+    }
+
+    StreamBuffer::Allocation StreamBuffer::upload(const void* data, GLsizeiptr bytes, GLsizeiptr alignment)
+    {
+        Allocation allocation;
+        if (!buffer || bytes <= 0 || bytes > size) {
+            if (bytes > 0) stats.failed++;
+            return allocation;
+        }
+
+        Placement placement = place(head, size, bytes, alignment);
+        GLsizeiptr offset = placement.offset;
+
+        // the bytes written one lap earlier must be retired; those of the current frame are not
+        // fenced yet (their draws may still be to come), so the frame cannot overrun itself
+        unsigned long long end = placement.start + bytes;
+        if (end > retired + size) {
+            unsigned long long position = end - size;
+            if (position > frameStart) {
+                stats.failed++;
+                return allocation;
+            }
+            waitForRetired(position);
+        }
+
+        if (mapped) {
+            std::memcpy(mapped + offset, data, bytes);
+        }
+        else {
+            // the fences already guarantee the range is free: no driver-side synchronization
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            void* target = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+            if (!target) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                stats.failed++;
+                return allocation;
+            }
+            std::memcpy(target, data, bytes);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        head = end;
+        if (placement.wrapped) stats.wraps++;
+        allocation.offset = offset;
+        allocation.size = bytes;
+        return allocation;
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef StreamBuffer_hpp
+#define StreamBuffer_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <deque>
+
+namespace gps {
+
+    // Ring allocator over one large buffer for data rewritten every frame (uniform blocks,
+    // instance attributes, light lists). Allocations are sub-ranges of getBuffer(), valid until
+    // the end of the frame they were made in: the caller binds them with glBindBufferRange /
+    // attribute offsets and uploads again next frame.
+    //
+    // With ARB_buffer_storage the buffer is mapped once (persistent + coherent) and an upload is
+    // a memcpy; on 4.1 core every upload maps its own range with GL_MAP_UNSYNCHRONIZED_BIT.
+    // Either way the driver never synchronizes: each frame's region is closed by a fence in
+    // beginFrame() and the ring only waits for a fence when it is about to overwrite that region
+    // (a stall, counted in getStats()).
+    class StreamBuffer {
+
+    public:
+        struct Allocation {
+            GLintptr offset = 0;
+            GLsizeiptr size = 0;        // 0: did not fit (the frame already filled the ring)
+
+            bool isValid() const { return size > 0; }
+        };
+
+        // where an allocation lands when the next free position is head: aligned, and moved to
+        // the start of the next lap rather than split across the end of the buffer
+        struct Placement {
+            unsigned long long start;   // absolute position
+            GLsizeiptr offset;          // start % size
+            bool wrapped;
+        };
+
+        struct Stats {
+            unsigned long long stalls = 0;      // waits on a fence the GPU had not reached yet
+            double stallMs = 0.0;
+            unsigned long long wraps = 0;
+            unsigned long long failed = 0;      // allocations that would overwrite this frame's data
+            GLsizeiptr lastFrameBytes = 0;      // alignment + wrap padding included
+            GLsizeiptr peakFrameBytes = 0;
+        };
+
+        ~StreamBuffer();
+
+        // allowPersistent = false forces the glMapBufferRange path (testing / broken drivers)
+        void create(GLsizeiptr size, bool allowPersistent = true);
+        void release();
+
+        // once per frame, before the first upload: fences the previous frame's region
+        void beginFrame();
+
+        // copies bytes into the ring at an offset that is a multiple of alignment
+        Allocation upload(const void* data, GLsizeiptr bytes, GLsizeiptr alignment);
+
+        GLuint getBuffer() const { return buffer; }
+        GLsizeiptr getSize() const { return size; }
+        bool isPersistent() const { return mapped != nullptr; }
+
+        const Stats& getStats() const { return stats; }
+        void resetStats() { stats = Stats(); }
+
+        // no GL involved; bytes <= size
+        static Placement place(unsigned long long head, GLsizeiptr size, GLsizeiptr bytes, GLsizeiptr alignment);
+
+    private:
+        // positions are absolute (monotonic); the buffer offset is position % size
+        struct Fence {
+            GLsync sync;
+            unsigned long long end;     // the region before this position was written before the fence
+        };
+
+        GLuint buffer = 0;
+        GLsizeiptr size = 0;
+        unsigned char* mapped = nullptr;
+
+        unsigned long long head = 0;            // next free position
+        unsigned long long frameStart = 0;      // head at the last beginFrame(), nothing after it is fenced
+        unsigned long long retired = 0;         // the GPU is done with everything before this
+        std::deque<Fence> fences;
+        Stats stats;
+
+        void waitForRetired(unsigned long long position);
+    };
+}
+
+#endif /* StreamBuffer_hpp */
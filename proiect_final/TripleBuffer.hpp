@@ -0,0 +1,49 @@
+#ifndef TripleBuffer_hpp
+#define TripleBuffer_hpp
+
+#include <atomic>
+
+namespace gps {
+
+    // Lock-free single-producer / single-consumer hand-off of the latest value.
+    // The producer fills writeSlot() and publish()es it; the consumer acquire()s the most recent
+    // published value and reads it through readSlot() until its next acquire(). Neither side ever
+    // waits: values published between two acquires are skipped (latest wins), so everything a
+    // value carries must be a full state, not a delta.
+    template <typename T>
+    class TripleBuffer {
+
+    public:
+        // producer
+        T& writeSlot() { return slots[back]; }
+
+        void publish()
+        {
+            int previous = ready.exchange(back | kFresh, std::memory_order_acq_rel);
+            back = previous & kIndexMask;
+        }
+
+        // consumer: false when nothing was published since the last acquire (readSlot unchanged)
+        bool acquire()
+        {
+            if (!(ready.load(std::memory_order_relaxed) & kFresh)) return false;
+
+            int previous = ready.exchange(front, std::memory_order_acq_rel);
+            front = previous & kIndexMask;
+            return true;
+        }
+
+        const T& readSlot() const { return slots[front]; }
+
+    private:
+        static constexpr int kIndexMask = 3;
+        static constexpr int kFresh = 4;    // set on publish, cleared by acquire
+
+        T slots[3] = {};
+        int back = 0;                       // producer only
+        int front = 1;                      // consumer only
+        std::atomic<int> ready{ 2 };        // slot index of the latest published value (+ kFresh)
+    };
+}
+
+#endif /* TripleBuffer_hpp */
@@ -0,0 +1,69 @@
+#include "UniformBuffer.hpp"
+#include "StreamBuffer.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+namespace gps {
+
+    UniformBuffer::~UniformBuffer()
+    {
+        if (ubo) glDeleteBuffers(1, &ubo);
+    }
+
+    void UniformBuffer::create(GLuint bindingPoint, GLsizeiptr size, StreamBuffer* stream)
+    {
+        this->bindingPoint = bindingPoint;
+        this->size = size;
+        this->stream = stream;
+
+        if (stream) {
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+            contents.assign(size, 0);
+        }
+
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
+    }
+
+    void UniformBuffer::update(const void* data)
+    {
+        if (stream) {
+            std::memcpy(contents.data(), data, size);
+            return;
+        }
+
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    void UniformBuffer::commitFrame()
+    {
+        if (!stream) return;
+
+        StreamBuffer::Allocation allocation = stream->upload(contents.data(), size, offsetAlignment);
+        if (allocation.isValid()) {
+            glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, stream->getBuffer(), allocation.offset, allocation.size);
+            return;
+        }
+
+        // the ring is full this frame: back to the own buffer
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, size, contents.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, ubo);
+    }
+
+    void UniformBuffer::attach(GLuint program, const char* blockName) const
+    {
+        GLuint blockIndex = glGetUniformBlockIndex(program, blockName);
+        if (blockIndex != GL_INVALID_INDEX) glUniformBlockBinding(program, blockIndex, bindingPoint);
+    }
+}
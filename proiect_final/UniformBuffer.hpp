@@ -0,0 +1,50 @@
+#ifndef UniformBuffer_hpp
+#define UniformBuffer_hpp
+
+#if defined (__APPLE__)
+#define GL_SILENCE_DEPRECATION
+#include <OpenGL/gl3.h>
+#else
+#define GLEW_STATIC
+#include <GL/glew.h>
+#endif
+
+#include <vector>
+
+namespace gps {
+
+    class StreamBuffer;
+
+    // One std140 uniform block on a fixed binding point.
+    // Every program that declares the block is attached to the same binding point, so a single
+    // write per frame reaches all of them.
+    // Without a StreamBuffer the block owns its buffer and update() orphans it. With one, update()
+    // only keeps a copy and commitFrame() places it in the ring (an allocation lives one frame,
+    // so the copy goes up every frame, dirty or not); the own buffer is the fallback.
+    class UniformBuffer {
+
+    public:
+        ~UniformBuffer();
+
+        void create(GLuint bindingPoint, GLsizeiptr size, StreamBuffer* stream = nullptr);
+
+        // own buffer: orphan + refill (no sync with draws still reading last frame's contents)
+        void update(const void* data);
+        // once per frame after the last update(), before the draws; no-op without a ring
+        void commitFrame();
+
+        // hooks the named block of a program to this buffer (no-op if the program does not use it)
+        void attach(GLuint program, const char* blockName) const;
+
+    private:
+        GLuint ubo = 0;
+        GLuint bindingPoint = 0;
+        GLsizeiptr size = 0;
+
+        StreamBuffer* stream = nullptr;
+        GLint offsetAlignment = 256;
+        std::vector<unsigned char> contents;
+    };
+}
+
+#endif /* UniformBuffer_hpp */
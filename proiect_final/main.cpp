@@ -22,9 +22,33 @@
 #include "Model3D.hpp"
 #include "Camera.hpp"
 #include "SkyBox.hpp"
-
+#include "ClusteredLights.hpp"
+#include "GBuffer.hpp"
+#include "UniformBuffer.hpp"
+#include "RenderStats.hpp"
+#include "GpuProfiler.hpp"
+#include "CpuProfiler.hpp"
+#include "FrameCapture.hpp"
+#include "ImpostorAtlas.hpp"
+#include "TripleBuffer.hpp"
+#include "JobSystem.hpp"
+#include "StreamBuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 // =========================
@@ -78,6 +102,19 @@ GLFWwindow* glWindow = NULL;
 
 gps::Model3D wildTown;
 
+// =========================
+// INCARCARE PROGRESIVA
+// OBJ-ul si texturile se citesc in fundal; fereastra randeaza de la primul frame,
+// mesh-urile apar pe masura ce ajung pe GPU (pumpSceneLoad, cateva ms pe frame)
+// --sync-load: asteapta tot modelul inainte de primul frame (implicit la benchmark / offscreen)
+// =========================
+bool asyncSceneLoad = true;
+bool sceneLoaded = false;
+std::atomic<bool> sceneLoadFailed{ false };   // OBJ-ul nu s-a putut citi: iesire cu cod 1
+bool firstFrameReported = false;
+double loadStartTime = 0.0;
+const double kLoadBudgetMs = 4.0;
+
 // Globale pentru SKYBOX
 gps::SkyBox skybox;
 gps::Shader skyboxShader;
@@ -85,16 +122,93 @@ gps::Shader skyboxShader;
 glm::mat4 model;
 GLuint modelLoc;
 glm::mat4 view;
-GLuint viewLoc;
 glm::mat4 projection;
-GLuint projectionLoc;
-glm::mat3 normalMatrix;
+glm::mat3 normalMatrix;   // inverse-transpose(model), WORLD (shader-ul aplica mat3(view))
 GLuint normalMatrixLoc;
 
+// =========================
+// UNIFORM BUFFERS (std140, shaders/uniformBlocks.glsl)
+// camera / lumini / ceata: scrise o data pe frame si citite de toate programele
+// ATENTIE: layout-ul trebuie sa ramana identic cu blocurile din shader
+// =========================
+struct CameraBlockData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 invView;
+    glm::mat4 invProjection;
+    glm::mat4 lightSpaceMatrix;
+};
+
+struct LightingBlockData {
+    glm::vec3 lightDir;        // eye space
+    GLint numPointLights;
+    glm::vec3 lightColor;
+    GLint enableShadows;
+};
+
+struct FogBlockData {
+    glm::vec3 fogColor;
+    float fogStart;
+    float fogEnd;
+    GLint fogEnabled;
+    float skyboxFog;
+    float pad0;
+};
+
+static_assert(sizeof(CameraBlockData) == 320, "CameraBlock std140");
+static_assert(offsetof(LightingBlockData, numPointLights) == 12 && offsetof(LightingBlockData, lightColor) == 16
+    && sizeof(LightingBlockData) == 32, "LightingBlock std140");
+static_assert(offsetof(FogBlockData, fogEnd) == 16 && offsetof(FogBlockData, skyboxFog) == 24
+    && sizeof(FogBlockData) == 32, "FogBlock std140");
+
+const GLuint kCameraBlockBinding = 0;
+const GLuint kLightingBlockBinding = 1;
+const GLuint kFogBlockBinding = 2;
+
+gps::UniformBuffer cameraUBO;
+gps::UniformBuffer lightingUBO;
+gps::UniformBuffer fogUBO;
+
+// =========================
+// STREAMING PE FRAME
+// un singur buffer mare folosit ca inel pentru tot ce se rescrie in fiecare frame: blocurile
+// uniform, instantele impostorilor, listele de lampi (o alocare e valabila un singur frame)
+// mapat persistent cu ARB_buffer_storage; --no-persistent-map: glMapBufferRange nesincronizat (4.1)
+// =========================
+gps::StreamBuffer streamBuffer;
+bool persistentMapEnabled = true;
+const GLsizeiptr kStreamBufferSize = 8 * 1024 * 1024;
+
+// =========================
+// DIRTY BITS
+// callback-urile (mouse, tastatura, resize) si miscarea doar modifica starea aplicatiei si
+// marcheaza ce s-a schimbat; flushDirtyState() trimite o singura data pe frame doar ce e murdar
+// (un mouse de 1000 Hz nu mai inseamna zeci de upload-uri pe frame)
+// =========================
+enum DirtyBits : unsigned {
+    DIRTY_CAMERA = 1u << 0,       // pozitie / orientare camera
+    DIRTY_PROJECTION = 1u << 1,   // dimensiunea ferestrei, planul far (urmeaza ceata)
+    DIRTY_MODEL = 1u << 2,        // transformarea scenei (si lampile din model)
+    DIRTY_LIGHTING = 1u << 3,     // toggle-uri lumini / umbre, setul de lampi
+    DIRTY_FOG = 1u << 4,          // ceata / skybox
+    DIRTY_SHADERS = 1u << 5,      // permutarea de umbre (programe de reconstruit)
+    DIRTY_LOD = 1u << 6,          // toggle / prag LOD si impostori
+
+    DIRTY_FRAME_STATE = DIRTY_CAMERA | DIRTY_PROJECTION | DIRTY_MODEL | DIRTY_LIGHTING | DIRTY_FOG | DIRTY_LOD
+};
+
+static unsigned gDirty = DIRTY_FRAME_STATE;
+
+static void markDirty(unsigned bits)
+{
+    gDirty |= bits;
+}
+
 // =========================
 // UMBRE
 // =========================
 gps::Shader shadowShader;
+GLint shadowModelLoc = -1;        // in shader-ul de umbre (lightSpaceMatrix vine din CameraBlock)
 
 const unsigned int SHADOW_W = 2048;
 const unsigned int SHADOW_H = 2048;
@@ -102,31 +216,111 @@ const unsigned int SHADOW_H = 2048;
 GLuint shadowFBO = 0;
 GLuint shadowDepthTex = 0;
 
+// sampler fara compare pe aceeasi textura (adancimi brute pentru blocker search PCSS)
+GLuint shadowRawSampler = 0;
+
 glm::mat4 lightSpaceMatrix;
-GLint lightSpaceMatrixLoc = -1;   // in shader-ul de scena
 GLint shadowMapLoc = -1;          // in shader-ul de scena
-GLint enableShadowsLoc = -1;      // in shader-ul de scena
+GLint shadowDepthMapLoc = -1;     // in shader-ul de scena (doar permutarea PCSS)
 
 bool enableShadows = true;
 
+// =========================
+// CALITATE FILTRARE UMBRE (tasta F)
+// fiecare nivel e o permutare a shaderPPL.frag (#define SHADOW_FILTER)
+// =========================
+enum ShadowFilter {
+    SF_HARDWARE = 0,     // un fetch sampler2DShadow (PCF 2x2 in hardware)
+    SF_POISSON = 1,      // 8 fetch-uri pe disc Poisson rotit (cat vechiul PCF 3x3)
+    SF_POISSON_16 = 2,   // 16 fetch-uri, la cerere (tasta F sau --shadow-taps 16)
+    SF_PCSS = 3,         // blocker search + penumbra variabila (16 fetch-uri)
+    SF_COUNT = 4
+};
+
+static ShadowFilter gShadowFilter = SF_POISSON;
+
+// SHADOW_FILTER si POISSON_TAPS din lighting.glsl
+static std::string shadowFilterDefines()
+{
+    int filter = 0, taps = 16;
+    switch (gShadowFilter) {
+    case SF_HARDWARE:   filter = 0; break;
+    case SF_POISSON:    filter = 1; taps = 8; break;
+    case SF_POISSON_16: filter = 1; break;
+    case SF_PCSS:       filter = 2; break;
+    default:            break;
+    }
+    return "#define SHADOW_FILTER " + std::to_string(filter) + "\n#define POISSON_TAPS " + std::to_string(taps);
+}
+
+static void reloadSceneShader();
+
+// =========================
+// FORMAT VERTEX (--packed-vertices): 16 octeti / vertex in loc de 32
+// pozitii unorm16 in cutia fiecarui mesh, normale 10:10:10:2, UV half (vezi gps::PackedVertex)
+// =========================
+static gps::VertexFormat gVertexFormat = gps::VERTEX_FLOAT;
+
+// programele care citesc mesh-urile (scena, G-buffer, pre-pass) decodeaza pozitia dupa format
+static std::string vertexFormatDefines()
+{
+    return gVertexFormat == gps::VERTEX_PACKED ? "#define PACKED_VERTICES 1\n" : "";
+}
+
+static std::string sceneShaderDefines()
+{
+    return vertexFormatDefines() + shadowFilterDefines();
+}
+
+// impostor.vert / .frag: dimensiunea grilei de cadre vine din ImpostorAtlas
+static std::string impostorDefines()
+{
+    return "#define IMPOSTOR_FRAMES " + std::to_string(gps::ImpostorAtlas::kFramesPerSide);
+}
+
+static const char* shadowFilterName(ShadowFilter f)
+{
+    switch (f) {
+    case SF_HARDWARE:   return "hardware 2x2";
+    case SF_POISSON:    return "Poisson 8";
+    case SF_POISSON_16: return "Poisson 16";
+    case SF_PCSS:       return "PCSS";
+    default:            return "?";
+    }
+}
+
 // Lumina directionala (WORLD)
 glm::vec3 lightDir;
-GLint lightDirLoc = -1;
 glm::vec3 lightColor;
-GLint lightColorLoc = -1;
 
 // =========================
 // MAI MULTE SURSE PUNCTUALE (lampi)
 // =========================
-static const int MAX_POINT_LIGHTS = 8;
+// fara limita fixa: luminile sunt repartizate pe clustere (froxeli) o data pe frame,
+// iar shaderPPL.frag itereaza doar luminile din clusterul fragmentului
+std::vector<gps::PointLight> pointLights;
+gps::ClusteredLights clusteredLights;
+
+// =========================
+// JOB SYSTEM (work stealing)
+// selectia LOD / cull pe mesh-uri si constructia clusterelor se impart pe workeri
+// --jobs N: numarul de workeri (implicit nucleele - 1, 0 = totul pe thread-ul apelant)
+// =========================
+std::unique_ptr<gps::JobSystem> jobSystem;
+int jobWorkers = -1;
 
-int numPointLights = 4;
-glm::vec3 pointLightPosWorld[MAX_POINT_LIGHTS];
-glm::vec3 pointLightColorArr[MAX_POINT_LIGHTS];
+// raza de influenta a unei lampi (WORLD) - lumina ajunge la 0 exact aici
+const float kPointLightRadius = 40.0f;
 
-GLint numPointLightsLoc = -1;
-GLint pointLightPosEyeLocArr[MAX_POINT_LIGHTS]{};
-GLint pointLightColorLocArr[MAX_POINT_LIGHTS]{};
+// unitatile de textura 5, 6, 7: lumini, grila de clustere, indici
+const int kClusterTexUnit = 5;
+
+// =========================
+// PROIECTIE
+// =========================
+const float kFovYDeg = 60.0f;
+const float kZNear = 0.1f;
+const float kZFar = 20000.0f;   // fara ceata; cu ceata planul far e fogEnd (currentZFar)
 
 // =========================
 // NOU: pozitia initiala a camerei (din valorile printate de tine)
@@ -151,8 +345,9 @@ float mouseSensitivity = 0.08f;
 bool firstMouse = true;
 double lastX = 0.0, lastY = 0.0;
 
-float walkSpeed = 0.25f;
-float flySpeedY = 0.6f;
+// unitati / secunda (simularea ruleaza cu pas fix, vezi kSimStep)
+float walkSpeed = 15.0f;
+float flySpeedY = 36.0f;
 float turboMult = 4.0f;
 
 float playerRadius = 0.01f;
@@ -163,6 +358,63 @@ float groundSnapEps = 0.05f;
 
 gps::Shader sceneShader;
 
+// =========================
+// DEPTH PRE-PASS (tasta G)
+// pozitii sortate fata -> spate, apoi pass-ul scump ruleaza cu GL_EQUAL
+// (fara overdraw in shaderPPL.frag)
+// =========================
+gps::Shader prepassShader;
+GLint prepassModelLoc = -1;
+
+bool depthPrepassEnabled = false;
+
+// =========================
+// NIVELURI DE DETALIU (tasta O: on/off, --lod-error px, --no-lod)
+// fiecare mesh foloseste cel mai simplu LOD (generat la incarcare) a carui eroare geometrica,
+// proiectata pe ecran din punctul cel mai apropiat al mesh-ului, ramane sub lodErrorPx
+// =========================
+bool lodEnabled = true;
+float lodErrorPx = 1.0f;
+
+// =========================
+// IMPOSTORI (tasta B: on/off, --impostor-px px, --no-impostors)
+// cladirile, grupate in clustere la incarcare (Model3D::getClusters), sunt coapte din 8x8 directii
+// intr-un atlas octaedric (albedo + normala + adancime); un cluster care ocupa sub impostorPx
+// pixeli pe ecran devine un singur quad orientat spre camera, cu cross-fade prin dithering
+// umbrele raman pe geometrie (LOD-ul cel mai simplu, la distanta asta)
+// =========================
+gps::ImpostorAtlas impostors;
+
+gps::Shader sceneFadeShader;         // shaderPPL + LOD_FADE: mesh-urile in cross-fade
+gps::Shader gbufferFadeShader;       // gbuffer.frag + LOD_FADE
+gps::Shader impostorShader;          // forward (aceeasi permutare SHADOW_FILTER ca shader-ul de scena)
+gps::Shader impostorGBufferShader;   // deferred (IMPOSTOR_GBUFFER)
+
+bool impostorsEnabled = true;
+float impostorPx = 64.0f;            // = ImpostorAtlas::kFrameSize: un texel de atlas ~ un pixel
+
+// =========================
+// RENDERER (tasta R sau --deferred): forward (shaderPPL.frag) sau deferred
+// deferred: G-buffer (albedo, normala, adancime) -> un pass full-screen cu directional + umbre
+// + lampi din aceeasi grila de clustere -> ceata ca post pass
+// =========================
+enum RendererPath {
+    RENDERER_FORWARD = 0,
+    RENDERER_DEFERRED = 1
+};
+
+static RendererPath gRenderer = RENDERER_FORWARD;
+
+gps::GBuffer gBuffer;
+GLuint fullscreenVAO = 0;   // gol, triunghiul full-screen vine din gl_VertexID
+
+gps::Shader gbufferShader;   // shaderPPL.vert + gbuffer.frag
+GLint gbufferModelLoc = -1;
+GLint gbufferNormalMatrixLoc = -1;
+
+gps::Shader deferredLightingShader;   // aceeasi permutare SHADOW_FILTER ca shader-ul de scena
+gps::Shader deferredFogShader;
+
 // =========================
 // CEATA (stil Silent Hill)
 // =========================
@@ -173,14 +425,6 @@ float fogEnd = 120.0f;
 // Optional: skybox "inghitit" de ceata (0..1)
 float skyboxFog = 1.0f;
 
-// Locatii uniforme pentru ceata (shader-ul de scena)
-GLint fogColorLoc = -1;
-GLint fogStartLoc = -1;
-GLint fogEndLoc = -1;
-
-// Uniforma de activare ceata (0/1) (shader-ul de scena)
-GLint fogEnabledLoc = -1;
-
 // =========================
 // TOGGLE CEATA + SKYBOX (tasta 3)
 // 3: ceata ON + skybox OFF
@@ -189,10 +433,6 @@ GLint fogEnabledLoc = -1;
 bool fogEnabled = false;     // start: fara ceata
 bool skyboxEnabled = true;   // start: skybox ON
 
-// Locatii uniforme pentru ceata in skybox
-GLint skyboxFogColorLoc = -1;
-GLint skyboxFogLoc = -1;
-
 // =========================
 // Controale transformare scena
 // I/J/K/L translatie, Q/E rotatie, Z/X scale, P auto demo
@@ -201,12 +441,78 @@ glm::vec3 sceneTranslate(0.0f, 0.0f, 0.0f);
 float sceneYawDeg = 0.0f;
 float sceneScale = 0.1f;
 
-float sceneTranslateStep = 0.30f;
-float sceneRotateStepDeg = 2.0f;
-float sceneScaleStep = 0.01f;
+// pe secunda
+float sceneTranslateStep = 18.0f;
+float sceneRotateStepDeg = 120.0f;
+float sceneScaleStep = 0.6f;
 
 bool autoDemo = false;
 double lastFrameTime = 0.0;
+
+// =========================
+// SIMULARE CU PAS FIX (miscare, coliziuni, tur)
+// randarea ruleaza cat de des poate si interpoleaza camera intre ultimele doua stari simulate
+// =========================
+const double kSimStep = 1.0 / 120.0;
+const int kMaxSimStepsPerFrame = 8;   // dupa un frame foarte lung nu mai recuperam tot timpul pierdut
+
+double simAccumulator = 0.0;
+
+struct CameraState {
+    glm::vec3 position;
+    glm::vec3 front;
+};
+
+static CameraState simPrevCamera;
+static CameraState simCurrCamera;
+
+// camera efectiv randata (interpolata); folosita de view, umbre si pre-pass
+static glm::vec3 renderCamPos = glm::vec3(0.0f);
+static glm::vec3 renderCamFront = glm::vec3(0.0f, 0.0f, -1.0f);
+
+bool vsyncEnabled = true;   // --no-vsync
+
+// =========================
+// HEADLESS (--headless [--osmesa]): fara server de display, ex. CI pe Mesa llvmpipe
+// platforma "null" din GLFW 3.4 + context EGL (implicit) sau OSMesa, fereastra invizibila
+// =========================
+bool headlessMode = false;
+bool headlessOSMesa = false;
+
+// =========================
+// RANDARE OFFSCREEN (headless): scena merge intr-un FBO, nu in fereastra
+// --render-poses fisier [--render-out prefix] [--render-size WxH] [--render-format ppm|png]
+// fisierul de poze: "px py pz tx ty tz" pe linie (pozitia camerei + punctul privit), '#' = comentariu
+// citirea e asincrona (PBO-uri) si encodarea pe thread-uri separate, suprapuse cu randarea
+// =========================
+gps::FrameCapture frameCapture;
+GLuint targetFramebuffer = 0;   // 0 = fereastra; FBO-ul din frameCapture in modul headless
+std::string renderPosesFile;
+std::string renderOut = "frame_";
+gps::FrameCapture::ImageFormat renderFormat = gps::FrameCapture::FORMAT_PPM;
+
+// =========================
+// BENCHMARK (--benchmark [--benchmark-frames N] [--benchmark-out prefix])
+// =========================
+// =========================
+// TIMPI GPU PE PASS-URI (tasta 9: afisare in consola + titlul ferestrei, o data pe secunda)
+// fiecare pass e masurat cu gps::GpuProfiler::Scope; un nume nou apare automat in raport
+// =========================
+gps::GpuProfiler gpuProfiler;
+bool gpuTimingOverlay = false;
+double gpuOverlayLastPrint = 0.0;
+const char* kWindowTitle = "Project Final - Wild Town";
+
+// =========================
+// PROFILER CPU (doar cu WT_PROFILING, configuratiile Debug)
+// tasta 0 sau --trace fisier.json: export pentru chrome://tracing / Perfetto
+// =========================
+std::string traceOut;
+
+bool benchmarkMode = false;
+bool benchmarkRunning = false;   // input ignorat (mouse / taste), doar ESC opreste rularea
+int benchmarkFrames = 1000;
+std::string benchmarkOut = "benchmark";
 float autoOrbitAngleDeg = 0.0f;
 float autoOrbitSpeedDeg = 18.0f;     // grade/secunda
 float autoSceneYawSpeedDeg = 6.0f;   // grade/secunda
@@ -313,6 +619,90 @@ static void applyRenderModeForNormalPass()
     applySmoothState(gSmoothEnabled);
 }
 
+// =========================
+// THREAD DE RANDARE (implicit in modul interactiv; --no-render-thread: totul pe un singur thread)
+// thread-ul principal: evenimente GLFW, simulare (miscare, coliziuni, tur), titlul ferestrei
+// thread-ul de randare: contextul GL, renderScene + swap, in ritmul lui (vsync)
+// intre ele doar FramePacket-uri printr-un triple buffer: randarea ia mereu cel mai nou pachet,
+// fara sa astepte simularea (un varf de coliziuni nu mai intarzie frame-ul)
+// ATENTIE: callback-urile si simularea nu scriu starea citita de randare (si nici gDirty);
+// toggle-urile de la tastatura ajung in inputToggles, iar randarea le preia din pachet
+// =========================
+struct RenderToggles {
+    bool enableDirLight;
+    bool enablePointLight;
+    bool enableShadows;
+    ShadowFilter shadowFilter;
+    bool depthPrepassEnabled;
+    bool lodEnabled;
+    bool impostorsEnabled;
+    RendererPath renderer;
+    bool fogEnabled;
+    bool skyboxEnabled;
+    float skyboxFog;
+    RenderMode renderMode;
+    bool smoothEnabled;
+    bool gpuTimingOverlay;
+};
+
+// tot ce citeste randarea despre un frame (stare completa, nu diferente: pachetele se pot sari)
+struct FramePacket {
+    glm::vec3 camPos;           // deja interpolata (simulare cu pas fix)
+    glm::vec3 camFront;
+    glm::mat4 model;            // T * R * S al scenei
+    int framebufferWidth;
+    int framebufferHeight;
+    RenderToggles toggles;
+};
+
+gps::TripleBuffer<FramePacket> framePackets;
+bool renderThreadEnabled = true;
+std::atomic<bool> renderThreadStop{ false };
+
+// partea thread-ului principal (callback-uri)
+RenderToggles inputToggles;
+int inputFramebufferWidth = 0;
+int inputFramebufferHeight = 0;
+
+// titlul cu timpii GPU e scris de randare, dar glfwSetWindowTitle merge doar pe thread-ul principal
+std::mutex windowTitleMutex;
+std::string pendingWindowTitle;
+
+static RenderToggles captureRenderToggles()
+{
+    return { enableDirLight, enablePointLight, enableShadows, gShadowFilter, depthPrepassEnabled,
+        lodEnabled, impostorsEnabled, gRenderer, fogEnabled, skyboxEnabled, skyboxFog,
+        gRenderMode, gSmoothEnabled, gpuTimingOverlay };
+}
+
+// pe thread-ul de randare: preia toggle-urile si marcheaza ce s-a schimbat
+static void applyRenderToggles(const RenderToggles& t)
+{
+    unsigned dirty = 0;
+    if (t.enableDirLight != enableDirLight || t.enablePointLight != enablePointLight || t.enableShadows != enableShadows)
+        dirty |= DIRTY_LIGHTING;
+    if (t.shadowFilter != gShadowFilter) dirty |= DIRTY_SHADERS;
+    if (t.lodEnabled != lodEnabled || t.impostorsEnabled != impostorsEnabled) dirty |= DIRTY_LOD;
+    if (t.fogEnabled != fogEnabled || t.skyboxEnabled != skyboxEnabled || t.skyboxFog != skyboxFog) dirty |= DIRTY_FOG;
+
+    enableDirLight = t.enableDirLight;
+    enablePointLight = t.enablePointLight;
+    enableShadows = t.enableShadows;
+    gShadowFilter = t.shadowFilter;
+    depthPrepassEnabled = t.depthPrepassEnabled;
+    lodEnabled = t.lodEnabled;
+    impostorsEnabled = t.impostorsEnabled;
+    gRenderer = t.renderer;
+    fogEnabled = t.fogEnabled;
+    skyboxEnabled = t.skyboxEnabled;
+    skyboxFog = t.skyboxFog;
+    gRenderMode = t.renderMode;
+    gSmoothEnabled = t.smoothEnabled;
+    gpuTimingOverlay = t.gpuTimingOverlay;
+
+    markDirty(dirty);
+}
+
 // =========================
 // Helper-e pentru UMBRE
 // =========================
@@ -326,14 +716,26 @@ static void initShadowMap()
     glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
         SHADOW_W, SHADOW_H, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // compare in hardware + GL_LINEAR => fiecare fetch din sampler2DShadow face PCF 2x2
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
     float borderColor[] = { 1.f, 1.f, 1.f, 1.f };
     glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
+    // sampler object pentru PCSS: aceeasi textura citita fara compare
+    glGenSamplers(1, &shadowRawSampler);
+    glSamplerParameteri(shadowRawSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(shadowRawSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glSamplerParameteri(shadowRawSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+    glSamplerParameteri(shadowRawSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glSamplerParameteri(shadowRawSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glSamplerParameterfv(shadowRawSampler, GL_TEXTURE_BORDER_COLOR, borderColor);
+
     glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowDepthTex, 0);
     glDrawBuffer(GL_NONE);
@@ -348,8 +750,7 @@ static void computeLightSpaceMatrix()
 {
     glm::vec3 Lrays = glm::normalize(lightDir);
 
-    glm::vec3 camPos = myCamera.getPosition();
-    glm::vec3 center(camPos.x, 0.0f, camPos.z);
+    glm::vec3 center(renderCamPos.x, 0.0f, renderCamPos.z);
 
     float lightDist = 120.0f;
     glm::vec3 lightPos = center - Lrays * lightDist;
@@ -367,96 +768,170 @@ static void computeLightSpaceMatrix()
     lightSpaceMatrix = lightProj * lightView;
 }
 
-// helper: seteaza fog uniforms pentru scena (sceneShader)
-static void setSceneFogUniforms()
+// lampile gasite in model (material *lightbulb*) -> WORLD, cu matricea model curenta
+static void refreshPointLightsFromModel()
 {
-    sceneShader.useShaderProgram();
-    if (fogColorLoc != -1) glUniform3fv(fogColorLoc, 1, glm::value_ptr(fogColor));
-    if (fogStartLoc != -1) glUniform1f(fogStartLoc, fogStart);
-    if (fogEndLoc != -1)   glUniform1f(fogEndLoc, fogEnd);
+    pointLights.clear();
+
+    for (const auto& bulb : wildTown.getEmissiveLights()) {
+        glm::vec3 pWorld = glm::vec3(model * glm::vec4(bulb.position, 1.0f));
+        pointLights.push_back({ pWorld, bulb.color, kPointLightRadius });
+    }
 
-    if (fogEnabledLoc != -1) glUniform1i(fogEnabledLoc, fogEnabled ? 1 : 0);
+    // fallback: lampa pusa manual, daca modelul nu are becuri
+    if (pointLights.empty()) {
+        pointLights.push_back({ glm::vec3(-4.0f, 21.5f, -25.0f), glm::vec3(1.0f, 0.85f, 0.45f), kPointLightRadius });
+    }
 }
 
-// helper: seteaza fog uniforms pentru skybox (skyboxShader)
-static void setSkyboxFogUniforms()
+// model + normalMatrix pentru programele fara locatii salvate (cross-fade, impostori)
+static void sendModelMatrices(gps::Shader& shader)
 {
-    skyboxShader.useShaderProgram();
-    if (skyboxFogColorLoc != -1) glUniform3fv(skyboxFogColorLoc, 1, glm::value_ptr(fogColor));
-    if (skyboxFogLoc != -1)      glUniform1f(skyboxFogLoc, skyboxFog);
+    if (!shader.shaderProgram) return;
+
+    shader.useShaderProgram();
+
+    GLint loc;
+    if ((loc = glGetUniformLocation(shader.shaderProgram, "model")) != -1)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(model));
+    if ((loc = glGetUniformLocation(shader.shaderProgram, "normalMatrix")) != -1)
+        glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+}
+
+// transformarea scenei T * R * S (partea de simulare: coliziuni, sol, FramePacket)
+static glm::mat4 sceneModelMatrix()
+{
+    glm::mat4 m = glm::mat4(1.0f);
+    m = glm::translate(m, sceneTranslate);
+    m = glm::rotate(m, glm::radians(sceneYawDeg), glm::vec3(0.0f, 1.0f, 0.0f));
+    m = glm::scale(m, glm::vec3(sceneScale));
+    return m;
 }
 
-// helper: recalculeaza model = T * R * S si trimite model + normalMatrix
+// helper: trimite model (setat din FramePacket / la init) + normalMatrix
+// (doar cand se schimba transformarea scenei; camera ajunge in shader prin CameraBlock)
 static void rebuildModelAndSend()
 {
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, sceneTranslate);
-    model = glm::rotate(model, glm::radians(sceneYawDeg), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::scale(model, glm::vec3(sceneScale));
+    // lampile se misca odata cu scena
+    refreshPointLightsFromModel();
+
+    normalMatrix = glm::mat3(glm::inverseTranspose(model));
 
     sceneShader.useShaderProgram();
     glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-    view = myCamera.getViewMatrix();
-    normalMatrix = glm::mat3(glm::inverseTranspose(view * model));
     glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
-}
 
-static void updateViewRelatedUniforms()
-{
-    view = myCamera.getViewMatrix();
-    normalMatrix = glm::mat3(glm::inverseTranspose(view * model));
+    gbufferShader.useShaderProgram();
+    glUniformMatrix4fv(gbufferModelLoc, 1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix3fv(gbufferNormalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
 
-    sceneShader.useShaderProgram();
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+    sendModelMatrices(sceneFadeShader);
+    sendModelMatrices(gbufferFadeShader);
+    sendModelMatrices(impostorShader);
+    sendModelMatrices(impostorGBufferShader);
+}
 
+// directia spre lumina (eye space) si culoarea efectiva, comune ambelor renderere
+static glm::vec3 lightDirEyeSpace()
+{
     glm::vec3 lightDirWorldToLight = -lightDir;
-    glm::vec3 lightDirEye = glm::inverseTranspose(glm::mat3(view)) * lightDirWorldToLight;
-    glUniform3fv(lightDirLoc, 1, glm::value_ptr(lightDirEye));
-
-    glm::vec3 dirColor = enableDirLight ? lightColor : glm::vec3(0.0f);
-    glUniform3fv(lightColorLoc, 1, glm::value_ptr(dirColor));
+    return glm::inverseTranspose(glm::mat3(view)) * lightDirWorldToLight;
+}
 
-    int activeCount = enablePointLight ? numPointLights : 0;
-    if (numPointLightsLoc != -1) glUniform1i(numPointLightsLoc, activeCount);
+static glm::vec3 dirLightColor()
+{
+    return enableDirLight ? lightColor : glm::vec3(0.0f);
+}
 
-    for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
-        if (pointLightPosEyeLocArr[i] == -1 || pointLightColorLocArr[i] == -1) continue;
+static int activePointLightCount()
+{
+    return enablePointLight ? (int)pointLights.size() : 0;
+}
 
-        if (i >= activeCount) {
-            glUniform3f(pointLightPosEyeLocArr[i], 0.0f, 0.0f, 0.0f);
-            glUniform3f(pointLightColorLocArr[i], 0.0f, 0.0f, 0.0f);
-            continue;
-        }
+// scrie doar blocurile afectate de bitii murdari (cel mult o data pe frame, din flushDirtyState)
+static void updateFrameUniformBlocks(unsigned dirty)
+{
+    if (dirty & (DIRTY_CAMERA | DIRTY_PROJECTION)) {
+        CameraBlockData camera;
+        camera.view = view;
+        camera.projection = projection;
+        camera.invView = glm::inverse(view);
+        camera.invProjection = glm::inverse(projection);
+        camera.lightSpaceMatrix = lightSpaceMatrix;
+        cameraUBO.update(&camera);
+    }
 
-        glm::vec3 pEye = glm::vec3(view * glm::vec4(pointLightPosWorld[i], 1.0f));
-        glUniform3fv(pointLightPosEyeLocArr[i], 1, glm::value_ptr(pEye));
-        glUniform3fv(pointLightColorLocArr[i], 1, glm::value_ptr(pointLightColorArr[i]));
+    // lightDir e in eye space, deci se schimba si cu camera
+    // pozitiile lampilor (eye space) ajung in shader prin clustere
+    if (dirty & (DIRTY_CAMERA | DIRTY_MODEL | DIRTY_LIGHTING)) {
+        LightingBlockData lighting;
+        lighting.lightDir = lightDirEyeSpace();
+        lighting.numPointLights = activePointLightCount();
+        lighting.lightColor = dirLightColor();
+        lighting.enableShadows = enableShadows ? 1 : 0;
+        lightingUBO.update(&lighting);
     }
 
-    if (enableShadowsLoc != -1) {
-        glUniform1i(enableShadowsLoc, enableShadows ? 1 : 0);
+    if (dirty & DIRTY_FOG) {
+        FogBlockData fog;
+        fog.fogColor = fogColor;
+        fog.fogStart = fogStart;
+        fog.fogEnd = fogEnd;
+        fog.fogEnabled = fogEnabled ? 1 : 0;
+        fog.skyboxFog = skyboxFog;
+        fog.pad0 = 0.0f;
+        fogUBO.update(&fog);
     }
 }
 
-void windowResizeCallback(GLFWwindow* window, int width, int height)
+static void initUniformBuffers()
 {
-    glfwGetFramebufferSize(window, &retina_width, &retina_height);
+    streamBuffer.create(kStreamBufferSize, persistentMapEnabled);
+    std::cout << "[STREAM] " << kStreamBufferSize / (1024 * 1024) << " MB ring, "
+        << (streamBuffer.isPersistent() ? "persistent map" : "unsynchronized map range") << "\n";
 
-    projection = glm::perspective(
-        glm::radians(60.0f),
-        (float)retina_width / (float)retina_height,
-        0.1f,
-        20000.0f
-    );
+    cameraUBO.create(kCameraBlockBinding, sizeof(CameraBlockData), &streamBuffer);
+    lightingUBO.create(kLightingBlockBinding, sizeof(LightingBlockData), &streamBuffer);
+    fogUBO.create(kFogBlockBinding, sizeof(FogBlockData), &streamBuffer);
 
-    sceneShader.useShaderProgram();
-    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    clusteredLights.setStreamBuffer(&streamBuffer);
+    impostors.setStreamBuffer(&streamBuffer);
+}
 
-    skyboxShader.useShaderProgram();
-    GLuint skyboxProjLoc = glGetUniformLocation(skyboxShader.shaderProgram, "projection");
-    glUniformMatrix4fv(skyboxProjLoc, 1, GL_FALSE, glm::value_ptr(projection));
+// leaga blocurile folosite de un program la buffer-ele de mai sus (dupa fiecare link)
+static void attachUniformBlocks(const gps::Shader& shader)
+{
+    cameraUBO.attach(shader.shaderProgram, "CameraBlock");
+    lightingUBO.attach(shader.shaderProgram, "LightingBlock");
+    fogUBO.attach(shader.shaderProgram, "FogBlock");
+}
+
+// cu ceata, dincolo de fogEnd totul are deja culoarea fogColor (ca si clear-ul), deci planul far
+// coboara la fogEnd: mai putina geometrie si precizie de adancime mult mai buna
+static float currentZFar()
+{
+    return fogEnabled ? fogEnd : kZFar;
+}
+
+// proiectia + grila de clustere (depinde de fov, aspect, dimensiunea viewport-ului si ceata)
+static void rebuildProjection()
+{
+    if (retina_width <= 0 || retina_height <= 0) return;
+
+    float aspect = (float)retina_width / (float)retina_height;
+    float zFar = currentZFar();
+    projection = glm::perspective(glm::radians(kFovYDeg), aspect, kZNear, zFar);
+
+    clusteredLights.setProjection(glm::radians(kFovYDeg), aspect, kZNear, zFar, retina_width, retina_height);
+}
+
+void windowResizeCallback(GLFWwindow* window, int width, int height)
+{
+    // offscreen: dimensiunea e cea a FBO-ului, nu a ferestrei
+    if (targetFramebuffer) return;
+
+    // ajunge la randare prin FramePacket (benchmark-urile pastreaza rezolutia de start)
+    glfwGetFramebufferSize(window, &inputFramebufferWidth, &inputFramebufferHeight);
 }
 
 void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int mode)
@@ -464,6 +939,9 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, GL_TRUE);
 
+    // benchmark: camera si setarile raman cele de la start (rulari comparabile)
+    if (benchmarkRunning) return;
+
     // P = toggle tur cinematic (autoDemo)
     if (key == GLFW_KEY_P && action == GLFW_PRESS) {
         autoDemo = !autoDemo;
@@ -475,37 +953,73 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
 
             // NOU: forteaza camera pe pozitia de start/ancora cand incepe preview-ul
             myCamera.setPosition(kTourAnchorPos);
-            updateViewRelatedUniforms();
         }
     }
 
+    // toggle-urile de randare: in inputToggles, randarea le preia din FramePacket
+    RenderToggles& toggles = inputToggles;
+
     if (key == GLFW_KEY_1 && action == GLFW_PRESS) {
-        enableDirLight = !enableDirLight;
-        updateViewRelatedUniforms();
+        toggles.enableDirLight = !toggles.enableDirLight;
     }
     if (key == GLFW_KEY_2 && action == GLFW_PRESS) {
-        enablePointLight = !enablePointLight;
-        updateViewRelatedUniforms();
+        toggles.enablePointLight = !toggles.enablePointLight;
     }
 
     // TOGGLE UMBRE
     if (key == GLFW_KEY_H && action == GLFW_PRESS) {
-        enableShadows = !enableShadows;
-        sceneShader.useShaderProgram();
-        if (enableShadowsLoc != -1) glUniform1i(enableShadowsLoc, enableShadows ? 1 : 0);
+        toggles.enableShadows = !toggles.enableShadows;
     }
 
-    // TOGGLE CEATA <-> SKYBOX (3)
-    if (key == GLFW_KEY_3 && action == GLFW_PRESS) {
-        fogEnabled = !fogEnabled;
-        skyboxEnabled = !fogEnabled; // cand ceata ON -> skybox OFF
+    // CALITATE UMBRE (F): hardware 2x2 -> Poisson 8 -> Poisson 16 -> PCSS
+    if (key == GLFW_KEY_F && action == GLFW_PRESS) {
+        toggles.shadowFilter = (ShadowFilter)((toggles.shadowFilter + 1) % SF_COUNT);
+        std::cout << "[SHADOWS] filter = " << shadowFilterName(toggles.shadowFilter) << "\n";
+    }
+
+    // TOGGLE DEPTH PRE-PASS (G)
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        toggles.depthPrepassEnabled = !toggles.depthPrepassEnabled;
+        std::cout << "[DEPTH PRE-PASS] " << (toggles.depthPrepassEnabled ? "ON" : "OFF") << "\n";
+    }
 
-        skyboxFog = fogEnabled ? 1.0f : 0.0f;
+    // TOGGLE LOD (O)
+    if (key == GLFW_KEY_O && action == GLFW_PRESS) {
+        toggles.lodEnabled = !toggles.lodEnabled;
+        std::cout << "[LOD] " << (toggles.lodEnabled ? "ON" : "OFF") << " (max error " << lodErrorPx << " px)\n";
+    }
 
-        sceneShader.useShaderProgram();
-        if (fogEnabledLoc != -1) glUniform1i(fogEnabledLoc, fogEnabled ? 1 : 0);
+    // TOGGLE IMPOSTORI (B)
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        toggles.impostorsEnabled = !toggles.impostorsEnabled;
+        std::cout << "[IMPOSTORS] " << (toggles.impostorsEnabled ? "ON" : "OFF") << " (clusters under " << impostorPx << " px)\n";
+    }
+
+    // FORWARD <-> DEFERRED (R)
+    if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+        toggles.renderer = (toggles.renderer == RENDERER_FORWARD) ? RENDERER_DEFERRED : RENDERER_FORWARD;
+        std::cout << "[RENDERER] " << (toggles.renderer == RENDERER_DEFERRED ? "deferred" : "forward") << "\n";
+    }
+
+#if defined(WT_PROFILING)
+    // EXPORT TRACE CPU (0)
+    if (key == GLFW_KEY_0 && action == GLFW_PRESS) {
+        WT_PROFILE_EXPORT("trace.json");
+    }
+#endif
+
+    // TIMPI GPU PE PASS-URI (9)
+    if (key == GLFW_KEY_9 && action == GLFW_PRESS) {
+        toggles.gpuTimingOverlay = !toggles.gpuTimingOverlay;
+        if (!toggles.gpuTimingOverlay) glfwSetWindowTitle(glWindow, kWindowTitle);
+    }
+
+    // TOGGLE CEATA <-> SKYBOX (3)
+    if (key == GLFW_KEY_3 && action == GLFW_PRESS) {
+        toggles.fogEnabled = !toggles.fogEnabled;
+        toggles.skyboxEnabled = !toggles.fogEnabled; // cand ceata ON -> skybox OFF
 
-        setSkyboxFogUniforms();
+        toggles.skyboxFog = toggles.fogEnabled ? 1.0f : 0.0f;
     }
 
     // TOGGLE MUZICA (M)
@@ -520,16 +1034,16 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
     // 4 = solid, 5 = wireframe, 6 = polygonal(points), 7 = toggle smooth
     // =========================
     if (key == GLFW_KEY_4 && action == GLFW_PRESS) {
-        gRenderMode = RM_SOLID;
+        toggles.renderMode = RM_SOLID;
     }
     if (key == GLFW_KEY_5 && action == GLFW_PRESS) {
-        gRenderMode = RM_WIREFRAME;
+        toggles.renderMode = RM_WIREFRAME;
     }
     if (key == GLFW_KEY_6 && action == GLFW_PRESS) {
-        gRenderMode = RM_POINTS;
+        toggles.renderMode = RM_POINTS;
     }
     if (key == GLFW_KEY_7 && action == GLFW_PRESS) {
-        gSmoothEnabled = !gSmoothEnabled;
+        toggles.smoothEnabled = !toggles.smoothEnabled;
     }
 
     // =========================
@@ -555,6 +1069,8 @@ void keyboardCallback(GLFWwindow* window, int key, int scancode, int action, int
 
 void mouseCallback(GLFWwindow* window, double xpos, double ypos)
 {
+    if (benchmarkRunning) return;
+
     if (firstMouse) {
         firstMouse = false;
         lastX = xpos;
@@ -572,15 +1088,16 @@ void mouseCallback(GLFWwindow* window, double xpos, double ypos)
     float pitchDelta = (float)yoffset * mouseSensitivity;
 
     myCamera.rotate(pitchDelta, yawDelta);
-    updateViewRelatedUniforms();
 }
 
 void applyGroundClamp()
 {
+    WT_PROFILE_FUNCTION();
+
     glm::vec3 pos = myCamera.getPosition();
 
     float groundY;
-    if (wildTown.getGroundHeightAtWorldXZ(model, pos.x, pos.z, groundY)) {
+    if (wildTown.getGroundHeightAtWorldXZ(sceneModelMatrix(), pos.x, pos.z, groundY)) {
         float minY = groundY + eyeHeight;
         if (pos.y < minY + groundSnapEps) {
             pos.y = minY;
@@ -622,9 +1139,6 @@ static void runAutoDemo(float dt)
     float pitchDelta = (targetPitch - curPitch) * k;
 
     myCamera.rotate(pitchDelta, yawDelta);
-
-    rebuildModelAndSend();
-    updateViewRelatedUniforms();
 }
 
 // Demo tur cinematic (folosit cand autoDemo este activ)
@@ -662,80 +1176,168 @@ static void runCinematicTour(float dt)
     float k = glm::clamp(dt * 6.0f, 0.0f, 1.0f);
     myCamera.rotate(pitchDelta * k, yawDelta * k);
 
-    rebuildModelAndSend();
-    updateViewRelatedUniforms();
-
     if (u >= 1.0f) {
         gTourIndex = (gTourIndex + 1) % (int)gTour.size();
         gTourT = 0.0f;
     }
 }
 
-void processMovement()
+void processMovement(float dt)
 {
+    WT_PROFILE_FUNCTION();
+
     static bool lastT = false;
     bool nowT = pressedKeys[GLFW_KEY_T];
     if (nowT && !lastT) lockToHumanHeight = !lockToHumanHeight;
     lastT = nowT;
 
-    bool sceneChanged = false;
-
-    if (pressedKeys[GLFW_KEY_I]) { sceneTranslate.z -= sceneTranslateStep; sceneChanged = true; }
-    if (pressedKeys[GLFW_KEY_K]) { sceneTranslate.z += sceneTranslateStep; sceneChanged = true; }
-    if (pressedKeys[GLFW_KEY_J]) { sceneTranslate.x -= sceneTranslateStep; sceneChanged = true; }
-    if (pressedKeys[GLFW_KEY_L]) { sceneTranslate.x += sceneTranslateStep; sceneChanged = true; }
+    float translateStep = sceneTranslateStep * dt;
+    float rotateStepDeg = sceneRotateStepDeg * dt;
+    float scaleStep = sceneScaleStep * dt;
 
-    if (pressedKeys[GLFW_KEY_Q]) { sceneYawDeg += sceneRotateStepDeg; sceneChanged = true; }
-    if (pressedKeys[GLFW_KEY_E]) { sceneYawDeg -= sceneRotateStepDeg; sceneChanged = true; }
+    // transformarea noua ajunge la randare prin FramePacket (sceneModelMatrix)
+    if (pressedKeys[GLFW_KEY_I]) sceneTranslate.z -= translateStep;
+    if (pressedKeys[GLFW_KEY_K]) sceneTranslate.z += translateStep;
+    if (pressedKeys[GLFW_KEY_J]) sceneTranslate.x -= translateStep;
+    if (pressedKeys[GLFW_KEY_L]) sceneTranslate.x += translateStep;
 
-    if (pressedKeys[GLFW_KEY_Z]) {
-        sceneScale = glm::max(0.01f, sceneScale - sceneScaleStep);
-        sceneChanged = true;
-    }
-    if (pressedKeys[GLFW_KEY_X]) {
-        sceneScale += sceneScaleStep;
-        sceneChanged = true;
-    }
+    if (pressedKeys[GLFW_KEY_Q]) sceneYawDeg += rotateStepDeg;
+    if (pressedKeys[GLFW_KEY_E]) sceneYawDeg -= rotateStepDeg;
 
-    if (sceneChanged) {
-        rebuildModelAndSend();
-        updateViewRelatedUniforms();
-    }
+    if (pressedKeys[GLFW_KEY_Z]) sceneScale = glm::max(0.01f, sceneScale - scaleStep);
+    if (pressedKeys[GLFW_KEY_X]) sceneScale += scaleStep;
 
     if (autoDemo) return;
 
     float speedMult = pressedKeys[GLFW_KEY_LEFT_SHIFT] ? turboMult : 1.0f;
-    float moveSpeed = walkSpeed * speedMult;
-
-    bool moved = false;
+    float moveSpeed = walkSpeed * speedMult * dt;
 
-    if (pressedKeys[GLFW_KEY_W]) { myCamera.move(gps::MOVE_FORWARD, moveSpeed); moved = true; }
-    if (pressedKeys[GLFW_KEY_S]) { myCamera.move(gps::MOVE_BACKWARD, moveSpeed); moved = true; }
-    if (pressedKeys[GLFW_KEY_A]) { myCamera.move(gps::MOVE_LEFT, moveSpeed); moved = true; }
-    if (pressedKeys[GLFW_KEY_D]) { myCamera.move(gps::MOVE_RIGHT, moveSpeed); moved = true; }
+    if (pressedKeys[GLFW_KEY_W]) myCamera.move(gps::MOVE_FORWARD, moveSpeed);
+    if (pressedKeys[GLFW_KEY_S]) myCamera.move(gps::MOVE_BACKWARD, moveSpeed);
+    if (pressedKeys[GLFW_KEY_A]) myCamera.move(gps::MOVE_LEFT, moveSpeed);
+    if (pressedKeys[GLFW_KEY_D]) myCamera.move(gps::MOVE_RIGHT, moveSpeed);
 
     if (!lockToHumanHeight) {
         glm::vec3 pos = myCamera.getPosition();
-        if (pressedKeys[GLFW_KEY_SPACE]) { pos.y += flySpeedY * speedMult; moved = true; }
-        if (pressedKeys[GLFW_KEY_LEFT_CONTROL]) { pos.y -= flySpeedY * speedMult; moved = true; }
+        if (pressedKeys[GLFW_KEY_SPACE]) pos.y += flySpeedY * speedMult * dt;
+        if (pressedKeys[GLFW_KEY_LEFT_CONTROL]) pos.y -= flySpeedY * speedMult * dt;
         myCamera.setPosition(pos);
     }
 
     {
         glm::vec3 pos = myCamera.getPosition();
-        wildTown.resolveSphereCollisions(model, pos, playerRadius);
+        wildTown.resolveSphereCollisions(sceneModelMatrix(), pos, playerRadius);
         myCamera.setPosition(pos);
     }
 
     if (lockToHumanHeight) {
         applyGroundClamp();
     }
+}
+
+static CameraState captureCamera()
+{
+    return { myCamera.getPosition(), myCamera.getFront() };
+}
+
+// un pas de simulare, mereu cu acelasi dt (rezultat independent de frame rate)
+static void simulationStep(float dt)
+{
+    // P activeaza/dezactiveaza autoDemo; cand e activ, rulam turul cinematic
+    if (autoDemo) runCinematicTour(dt);
+    else processMovement(dt);
+}
+
+// consuma timpul real al frame-ului in pasi fixi de kSimStep
+static void advanceSimulation(double frameDt)
+{
+    WT_PROFILE_FUNCTION();
+
+    simAccumulator += frameDt;
+
+    int steps = 0;
+    while (simAccumulator >= kSimStep && steps < kMaxSimStepsPerFrame) {
+        // starea de start a pasului (prinde si teleportarile facute din afara simularii, ex. tasta P)
+        simPrevCamera = captureCamera();
+        simulationStep((float)kSimStep);
+        simCurrCamera = captureCamera();
+
+        simAccumulator -= kSimStep;
+        steps++;
+    }
+
+    // frame prea lung (breakpoint, mutarea ferestrei): aruncam restul in loc sa acceleram simularea
+    if (steps == kMaxSimStepsPerFrame) simAccumulator = 0.0;
+}
+
+// camera randata = interpolare intre ultimele doua stari simulate
+static CameraState interpolatedCamera()
+{
+    float alpha = (float)(simAccumulator / kSimStep);
+
+    CameraState camera;
+    camera.position = glm::mix(simPrevCamera.position, simCurrCamera.position, alpha);
+
+    // orientarea vine direct din mouse (fara latenta), in afara de tur unde o roteste simularea
+    camera.front = myCamera.getFront();
+    if (autoDemo) camera.front = glm::normalize(glm::mix(simPrevCamera.front, simCurrCamera.front, alpha));
+    return camera;
+}
+
+// thread-ul principal: starea de dupa simulare, pentru randare
+static void buildFramePacket(FramePacket& packet)
+{
+    CameraState camera = interpolatedCamera();
+    packet.camPos = camera.position;
+    packet.camFront = camera.front;
+    packet.model = sceneModelMatrix();
+    packet.framebufferWidth = inputFramebufferWidth;
+    packet.framebufferHeight = inputFramebufferHeight;
+    packet.toggles = inputToggles;
+}
+
+// thread-ul de randare: copiaza pachetul in starea randarii si marcheaza doar ce difera
+static void applyFramePacket(const FramePacket& packet)
+{
+    if (packet.camPos != renderCamPos || packet.camFront != renderCamFront) {
+        renderCamPos = packet.camPos;
+        renderCamFront = packet.camFront;
+        markDirty(DIRTY_CAMERA);
+    }
+
+    if (packet.model != model) {
+        model = packet.model;
+        markDirty(DIRTY_MODEL);
+    }
+
+    // offscreen: dimensiunea e cea a FBO-ului
+    if (!targetFramebuffer && (packet.framebufferWidth != retina_width || packet.framebufferHeight != retina_height)) {
+        retina_width = packet.framebufferWidth;
+        retina_height = packet.framebufferHeight;
+        markDirty(DIRTY_PROJECTION);
+    }
 
-    if (moved) updateViewRelatedUniforms();
+    applyRenderToggles(packet.toggles);
+}
+
+// fara istoric de interpolare (start, benchmark-uri)
+static void resetSimulationCamera()
+{
+    simPrevCamera = simCurrCamera = captureCamera();
+    simAccumulator = 0.0;
+    renderCamPos = simCurrCamera.position;
+    renderCamFront = simCurrCamera.front;
+    markDirty(DIRTY_CAMERA);
 }
 
 bool initOpenGLWindow()
 {
+#if defined(GLFW_PLATFORM_NULL)
+    if (headlessMode) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    if (headlessMode) std::cout << "[HEADLESS] GLFW < 3.4: no null platform, using the default one\n";
+#endif
+
     if (!glfwInit()) return false;
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -746,7 +1348,15 @@ bool initOpenGLWindow()
     glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
     glfwWindowHint(GLFW_SAMPLES, 4);
 
-    glWindow = glfwCreateWindow(glWindowWidth, glWindowHeight, "Project Final - Wild Town", NULL, NULL);
+    if (headlessMode) {
+        // se randeaza in FBO-ul offscreen; fereastra (daca exista) nu are nevoie de MSAA
+        glfwWindowHint(GLFW_SAMPLES, 0);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+            headlessOSMesa ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+    }
+
+    glWindow = glfwCreateWindow(glWindowWidth, glWindowHeight, kWindowTitle, NULL, NULL);
     if (!glWindow) {
         glfwTerminate();
         return false;
@@ -759,20 +1369,39 @@ bool initOpenGLWindow()
     glfwSetInputMode(glWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     glfwMakeContextCurrent(glWindow);
-    glfwSwapInterval(1);
+    glfwSwapInterval(vsyncEnabled ? 1 : 0);
 
 #if not defined (__APPLE__)
     glewExperimental = GL_TRUE;
-    glewInit();
+    // glewInit() cere si GLX/WGL; pe un context EGL/OSMesa incarcam doar functiile GL
+    if (headlessMode) glewContextInit();
+    else glewInit();
 #endif
 
     glfwGetFramebufferSize(glWindow, &retina_width, &retina_height);
     return true;
 }
 
+// modul headless: tot ce ar ajunge in fereastra ajunge in FBO-ul offscreen (aceeasi dimensiune)
+static bool initOffscreenTarget()
+{
+    if (!frameCapture.init(glWindowWidth, glWindowHeight)) return false;
+
+    targetFramebuffer = frameCapture.getFramebuffer();
+    retina_width = frameCapture.getWidth();
+    retina_height = frameCapture.getHeight();
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    return true;
+}
+
 void initObjects()
 {
-    wildTown.LoadModel("models/wild_town/wild_town.obj");
+    wildTown.setVertexFormat(gVertexFormat);
+    wildTown.setJobSystem(jobSystem.get());
+
+    loadStartTime = glfwGetTime();
+    if (asyncSceneLoad) wildTown.LoadModelAsync("models/wild_town/wild_town.obj");
+    else wildTown.LoadModel("models/wild_town/wild_town.obj");
 
     std::vector<const GLchar*> faces = {
         "skybox/posx.jpg",
@@ -787,80 +1416,188 @@ void initObjects()
 
 void initShaders()
 {
-    sceneShader.loadShader("shaders/shaderPPL.vert", "shaders/shaderPPL.frag");
+    sceneShader.loadShader("shaders/shaderPPL.vert", "shaders/shaderPPL.frag", sceneShaderDefines());
+    attachUniformBlocks(sceneShader);
     sceneShader.useShaderProgram();
 
     skyboxShader.loadShader("shaders/skyboxShader.vert", "shaders/skyboxShader.frag");
+    attachUniformBlocks(skyboxShader);
     skyboxShader.useShaderProgram();
 
     shadowShader.loadShader("shaders/shadowDepth.vert", "shaders/shadowDepth.frag");
-}
+    attachUniformBlocks(shadowShader);
+    shadowModelLoc = glGetUniformLocation(shadowShader.shaderProgram, "model");
 
-void initUniforms()
-{
-    sceneTranslate = glm::vec3(0.0f, 0.0f, 0.0f);
-    sceneYawDeg = 0.0f;
-    sceneScale = 0.1f;
+    prepassShader.loadShader("shaders/depthPrepass.vert", "shaders/shadowDepth.frag", vertexFormatDefines());
+    attachUniformBlocks(prepassShader);
+    prepassModelLoc = glGetUniformLocation(prepassShader.shaderProgram, "model");
 
-    view = myCamera.getViewMatrix();
-    projection = glm::perspective(
-        glm::radians(60.0f),
-        (float)retina_width / (float)retina_height,
-        0.1f,
-        20000.0f
-    );
+    gbufferShader.loadShader("shaders/shaderPPL.vert", "shaders/gbuffer.frag", vertexFormatDefines());
+    attachUniformBlocks(gbufferShader);
+    gbufferModelLoc = glGetUniformLocation(gbufferShader.shaderProgram, "model");
+    gbufferNormalMatrixLoc = glGetUniformLocation(gbufferShader.shaderProgram, "normalMatrix");
 
-    lightDir = glm::normalize(glm::vec3(-0.2f, -1.0f, -0.35f));
-    lightColor = glm::vec3(1.0f);
+    gbufferFadeShader.loadShader("shaders/shaderPPL.vert", "shaders/gbuffer.frag", vertexFormatDefines() + "#define LOD_FADE 1");
+    attachUniformBlocks(gbufferFadeShader);
 
-    numPointLights = 1;
-    pointLightPosWorld[0] = glm::vec3(-4.0f, 21.5f, -25.0f);
-    pointLightColorArr[0] = glm::vec3(1.0f, 0.85f, 0.45f);
+    impostorGBufferShader.loadShader("shaders/impostor.vert", "shaders/impostor.frag", impostorDefines() + "\n#define IMPOSTOR_GBUFFER 1");
+    attachUniformBlocks(impostorGBufferShader);
 
-    sceneShader.useShaderProgram();
+    deferredFogShader.loadShader("shaders/fullscreen.vert", "shaders/deferredFog.frag");
+    attachUniformBlocks(deferredFogShader);
+    deferredFogShader.useShaderProgram();
+    glUniform1i(glGetUniformLocation(deferredFogShader.shaderProgram, "gDepth"), 2);
 
+    glGenVertexArrays(1, &fullscreenVAO);
+}
+
+// locatiile uniformelor din shader-ul de scena (se reiau la fiecare reincarcare a programului)
+static void fetchSceneUniformLocations()
+{
+    sceneShader.useShaderProgram();
+
+    // camera, lumini, ceata: blocurile uniforme (attachUniformBlocks)
     modelLoc = glGetUniformLocation(sceneShader.shaderProgram, "model");
-    viewLoc = glGetUniformLocation(sceneShader.shaderProgram, "view");
-    projectionLoc = glGetUniformLocation(sceneShader.shaderProgram, "projection");
     normalMatrixLoc = glGetUniformLocation(sceneShader.shaderProgram, "normalMatrix");
 
-    lightDirLoc = glGetUniformLocation(sceneShader.shaderProgram, "lightDir");
-    lightColorLoc = glGetUniformLocation(sceneShader.shaderProgram, "lightColor");
+    shadowMapLoc = glGetUniformLocation(sceneShader.shaderProgram, "shadowMap");
+    shadowDepthMapLoc = glGetUniformLocation(sceneShader.shaderProgram, "shadowDepthMap");
+}
+
+// trimite toata starea curenta catre shader-ul de scena
+static void sendSceneUniforms()
+{
+    sceneShader.useShaderProgram();
+
+    if (shadowMapLoc != -1) glUniform1i(shadowMapLoc, 3);
+    if (shadowDepthMapLoc != -1) glUniform1i(shadowDepthMapLoc, 4);
 
-    fogColorLoc = glGetUniformLocation(sceneShader.shaderProgram, "fogColor");
-    fogStartLoc = glGetUniformLocation(sceneShader.shaderProgram, "fogStart");
-    fogEndLoc = glGetUniformLocation(sceneShader.shaderProgram, "fogEnd");
+    rebuildModelAndSend();
+
+    clusteredLights.setUniforms(sceneShader.shaderProgram, kClusterTexUnit);
+}
 
-    fogEnabledLoc = glGetUniformLocation(sceneShader.shaderProgram, "fogEnabled");
-    if (fogEnabledLoc != -1) glUniform1i(fogEnabledLoc, fogEnabled ? 1 : 0);
+// pass-ul full-screen al renderer-ului deferred (G-buffer pe unitatile 0..2, umbre pe 3/4, clustere pe 5..7)
+static void loadDeferredLightingShader()
+{
+    GLuint oldProgram = deferredLightingShader.shaderProgram;
+    deferredLightingShader.loadShader("shaders/fullscreen.vert", "shaders/deferredLighting.frag", shadowFilterDefines());
+    if (oldProgram) glDeleteProgram(oldProgram);
+    attachUniformBlocks(deferredLightingShader);
+
+    GLuint program = deferredLightingShader.shaderProgram;
+    deferredLightingShader.useShaderProgram();
+
+    GLint loc;
+    if ((loc = glGetUniformLocation(program, "gAlbedo")) != -1) glUniform1i(loc, 0);
+    if ((loc = glGetUniformLocation(program, "gNormal")) != -1) glUniform1i(loc, 1);
+    if ((loc = glGetUniformLocation(program, "gDepth")) != -1) glUniform1i(loc, 2);
+    if ((loc = glGetUniformLocation(program, "shadowMap")) != -1) glUniform1i(loc, 3);
+    if ((loc = glGetUniformLocation(program, "shadowDepthMap")) != -1) glUniform1i(loc, 4);
+
+    clusteredLights.setUniforms(program, kClusterTexUnit);
+}
 
-    numPointLightsLoc = glGetUniformLocation(sceneShader.shaderProgram, "numPointLights");
-    for (int i = 0; i < MAX_POINT_LIGHTS; i++) {
-        std::string posName = "pointLightPosEye[" + std::to_string(i) + "]";
-        std::string colName = "pointLightColor[" + std::to_string(i) + "]";
-        pointLightPosEyeLocArr[i] = glGetUniformLocation(sceneShader.shaderProgram, posName.c_str());
-        pointLightColorLocArr[i] = glGetUniformLocation(sceneShader.shaderProgram, colName.c_str());
+// variantele iluminate pentru impostori: mesh-urile in cross-fade (LOD_FADE) si quad-urile lor;
+// aceeasi permutare SHADOW_FILTER ca shader-ul de scena, deci se reincarca odata cu el
+static void loadImpostorLitShaders()
+{
+    GLuint oldFadeProgram = sceneFadeShader.shaderProgram;
+    GLuint oldImpostorProgram = impostorShader.shaderProgram;
+    sceneFadeShader.loadShader("shaders/shaderPPL.vert", "shaders/shaderPPL.frag", sceneShaderDefines() + "\n#define LOD_FADE 1");
+    impostorShader.loadShader("shaders/impostor.vert", "shaders/impostor.frag", shadowFilterDefines() + "\n" + impostorDefines());
+    if (oldFadeProgram) glDeleteProgram(oldFadeProgram);
+    if (oldImpostorProgram) glDeleteProgram(oldImpostorProgram);
+
+    for (gps::Shader* shader : { &sceneFadeShader, &impostorShader }) {
+        attachUniformBlocks(*shader);
+        shader->useShaderProgram();
+
+        GLint loc;
+        if ((loc = glGetUniformLocation(shader->shaderProgram, "shadowMap")) != -1) glUniform1i(loc, 3);
+        if ((loc = glGetUniformLocation(shader->shaderProgram, "shadowDepthMap")) != -1) glUniform1i(loc, 4);
+        clusteredLights.setUniforms(shader->shaderProgram, kClusterTexUnit);
+
+        sendModelMatrices(*shader);
     }
+}
 
-    lightSpaceMatrixLoc = glGetUniformLocation(sceneShader.shaderProgram, "lightSpaceMatrix");
-    shadowMapLoc = glGetUniformLocation(sceneShader.shaderProgram, "shadowMap");
-    enableShadowsLoc = glGetUniformLocation(sceneShader.shaderProgram, "enableShadows");
+// atlasul impostorilor, o data dupa incarcarea modelului (programul de coacere nu mai trebuie dupa)
+static void initImpostors()
+{
+    gps::Shader bakeShader;
+    bakeShader.loadShader("shaders/impostorBake.vert", "shaders/impostorBake.frag", vertexFormatDefines());
+    impostors.bake(wildTown, bakeShader);
+    glDeleteProgram(bakeShader.shaderProgram);
+}
 
-    if (shadowMapLoc != -1) glUniform1i(shadowMapLoc, 3);
-    if (enableShadowsLoc != -1) glUniform1i(enableShadowsLoc, enableShadows ? 1 : 0);
+// thread-ul GL, la inceputul fiecarui frame cat timp modelul nu e complet
+static void pumpSceneLoad()
+{
+    if (sceneLoaded) return;
 
-    rebuildModelAndSend();
+    size_t meshesBefore = wildTown.getMeshCount();
+    bool geometryBefore = wildTown.isGeometryComplete();
 
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    sceneLoaded = wildTown.pumpUploads(kLoadBudgetMs);
 
-    setSceneFogUniforms();
-    updateViewRelatedUniforms();
+    // loader-ul doar raporteaza esecul; inchiderea se face normal, din main (cleanup pe thread-ul GL)
+    if (sceneLoaded && wildTown.hasLoadFailed()) {
+        std::cerr << "[LOAD] could not read the scene, shutting down\n";
+        sceneLoadFailed = true;
+        glfwSetWindowShouldClose(glWindow, GLFW_TRUE);
+        return;
+    }
 
-    skyboxShader.useShaderProgram();
-    skyboxFogColorLoc = glGetUniformLocation(skyboxShader.shaderProgram, "fogColor");
-    skyboxFogLoc = glGetUniformLocation(skyboxShader.shaderProgram, "skyboxFog");
-    setSkyboxFogUniforms();
+    // mesh-uri noi: LOD + cull si pentru ele
+    if (wildTown.getMeshCount() != meshesBefore) markDirty(DIRTY_LOD);
+
+    // toata geometria: lampile din model, depth stream-ul (umbre, pre-pass)
+    if (!geometryBefore && wildTown.isGeometryComplete()) markDirty(DIRTY_MODEL | DIRTY_LOD);
+
+    // si toate texturile: impostorii se coc din scena completa
+    if (sceneLoaded) {
+        initImpostors();
+        markDirty(DIRTY_LOD);
+        std::cout << "[LOAD] scene loaded after " << (int)((glfwGetTime() - loadStartTime) * 1000.0) << " ms\n";
+    }
+}
+
+static void reloadSceneShader()
+{
+    GLuint oldProgram = sceneShader.shaderProgram;
+    sceneShader.loadShader("shaders/shaderPPL.vert", "shaders/shaderPPL.frag", sceneShaderDefines());
+    glDeleteProgram(oldProgram);
+    attachUniformBlocks(sceneShader);
+
+    fetchSceneUniformLocations();
+    sendSceneUniforms();
+
+    loadDeferredLightingShader();
+    loadImpostorLitShaders();
+}
+
+void initUniforms()
+{
+    sceneTranslate = glm::vec3(0.0f, 0.0f, 0.0f);
+    sceneYawDeg = 0.0f;
+    sceneScale = 0.1f;
+    model = sceneModelMatrix();
+
+    view = myCamera.getViewMatrix();
+
+    clusteredLights.init(16, 9, 24);
+    clusteredLights.setJobSystem(jobSystem.get());
+    rebuildProjection();
+
+    lightDir = glm::normalize(glm::vec3(-0.2f, -1.0f, -0.35f));
+    lightColor = glm::vec3(1.0f);
+
+    fetchSceneUniformLocations();
+    sendSceneUniforms();
+
+    loadDeferredLightingShader();
+    loadImpostorLitShaders();
 }
 
 void initOpenGLState()
@@ -876,17 +1613,225 @@ void initOpenGLState()
     glFrontFace(GL_CCW);
 }
 
+// doar adancime, fata -> spate (early-Z maxim pentru pass-ul principal)
+static void renderDepthPrepass()
+{
+    gps::GpuProfiler::Scope gpuScope(gpuProfiler, "prepass");
+
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    prepassShader.useShaderProgram();
+    glUniformMatrix4fv(prepassModelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+    glm::vec3 eyeLocal = glm::vec3(glm::inverse(model) * glm::vec4(renderCamPos, 1.0f));
+    wildTown.DrawDepthSorted(eyeLocal);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+// dupa geometria opaca, cu GL_LESS: mesh-urile in cross-fade (dithering) si quad-urile impostorilor
+static void renderImpostors(gps::Shader& fadeShader, gps::Shader& impostorProgram)
+{
+    if (impostors.getDrawCount() == 0) return;
+
+    gps::GpuProfiler::Scope gpuScope(gpuProfiler, "impostors");
+    wildTown.DrawFading(fadeShader);
+    impostors.Draw(impostorProgram);
+}
+
+static void clearMainFramebuffer()
+{
+    if (fogEnabled) glClearColor(fogColor.r, fogColor.g, fogColor.b, 1.0f);
+    else glClearColor(0.05f, 0.06f, 0.08f, 1.0f);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+// 2) FORWARD: shaderPPL.frag face tot (material + lumini + umbre + ceata) per fragment
+static void renderForwardPass()
+{
+    WT_PROFILE_FUNCTION();
+
+    glViewport(0, 0, retina_width, retina_height);
+
+    // Aplica modul de randare cerut doar pentru pass-ul normal
+    applyRenderModeForNormalPass();
+
+    clearMainFramebuffer();
+
+    sceneShader.useShaderProgram();
+
+    // pre-pass doar in modul SOLID (liniile/punctele nu au aceeasi adancime ca triunghiurile pline)
+    // si doar cu toata geometria incarcata (depth stream-ul se construieste la final)
+    bool usePrepass = depthPrepassEnabled && gRenderMode == RM_SOLID && wildTown.isGeometryComplete();
+    if (usePrepass) {
+        renderDepthPrepass();
+        sceneShader.useShaderProgram();
+
+        glDepthFunc(GL_EQUAL);
+        glDepthMask(GL_FALSE);
+    }
+
+    {
+        gps::GpuProfiler::Scope gpuScope(gpuProfiler, "forward");
+        wildTown.Draw(sceneShader);
+    }
+
+    if (usePrepass) {
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+    }
+
+    renderImpostors(sceneFadeShader, impostorShader);
+}
+
+// 2) DEFERRED: geometria o singura data in G-buffer, apoi luminile costa o data per pixel
+static void renderDeferredPasses()
+{
+    WT_PROFILE_FUNCTION();
+
+    // 2a) G-BUFFER (aceleasi Model3D/Mesh si acelasi vertex shader, alt fragment shader)
+    gBuffer.resize(retina_width, retina_height);
+    {
+        gps::GpuProfiler::Scope gpuScope(gpuProfiler, "gbuffer");
+        gBuffer.bindForGeometryPass();
+
+        applyRenderModeForNormalPass();
+
+        gbufferShader.useShaderProgram();
+        wildTown.Draw(gbufferShader);
+    }
+    renderImpostors(gbufferFadeShader, impostorGBufferShader);
+
+    // 2b) ILUMINARE: directional + umbre + lampi (clustere), un triunghi full-screen
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, retina_width, retina_height);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    clearMainFramebuffer();
+
+    gBuffer.bindTextures(0);
+
+    deferredLightingShader.useShaderProgram();
+
+    // adancimea din G-buffer ajunge in framebuffer (gl_FragDepth), ca skybox-ul sa acopere doar cerul
+    glDepthFunc(GL_ALWAYS);
+    glBindVertexArray(fullscreenVAO);
+    {
+        gps::GpuProfiler::Scope gpuScope(gpuProfiler, "deferred lighting");
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        gps::renderStats.addDraw(3);
+    }
+    glDepthFunc(GL_LESS);
+
+    // 2c) CEATA ca post pass (blending peste rezultatul iluminat)
+    if (fogEnabled) {
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        deferredFogShader.useShaderProgram();
+        {
+            gps::GpuProfiler::Scope gpuScope(gpuProfiler, "deferred fog");
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            gps::renderStats.addDraw(3);
+        }
+
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    glBindVertexArray(0);
+}
+
+// singurul loc unde starea modificata de input ajunge pe GPU (o data pe frame, inainte de umbre)
+static void flushDirtyState()
+{
+    WT_PROFILE_FUNCTION();
+
+    unsigned dirty = gDirty;
+    gDirty = 0;
+
+    // planul far si distanta de culling urmeaza ceata (tasta 3)
+    if (dirty & DIRTY_FOG) dirty |= DIRTY_PROJECTION;
+
+    if (dirty & DIRTY_PROJECTION) {
+        rebuildProjection();
+        clusteredLights.setUniforms(sceneShader.shaderProgram, kClusterTexUnit);
+        clusteredLights.setUniforms(deferredLightingShader.shaderProgram, kClusterTexUnit);
+        clusteredLights.setUniforms(sceneFadeShader.shaderProgram, kClusterTexUnit);
+        clusteredLights.setUniforms(impostorShader.shaderProgram, kClusterTexUnit);
+    }
+
+    // programele noi primesc tot (samplere, model, clustere)
+    if (dirty & DIRTY_SHADERS) reloadSceneShader();
+
+    if (dirty & DIRTY_MODEL) rebuildModelAndSend();
+
+    if (dirty & DIRTY_CAMERA) {
+        view = myCamera.getViewMatrixAt(renderCamPos, renderCamFront);
+        computeLightSpaceMatrix();
+    }
+
+    updateFrameUniformBlocks(dirty);
+
+    // LOD-urile: acelasi set pentru umbre, pre-pass si pass-ul principal (GL_EQUAL)
+    // impostorii: clusterele prea mici pe ecran ies din pre-pass si din pass-ul principal
+    // ceata: mesh-urile si impostorii cu punctul cel mai apropiat dincolo de planul far nu se mai trimit
+    // (distanta in MODEL-LOCAL: scena are scalare uniforma, lungimea unei coloane din model)
+    if (dirty & (DIRTY_CAMERA | DIRTY_PROJECTION | DIRTY_MODEL | DIRTY_LOD)) {
+        glm::vec3 eyeLocal = glm::vec3(glm::inverse(model) * glm::vec4(renderCamPos, 1.0f));
+        float pixelsPerUnit = (float)retina_height / (2.0f * std::tan(glm::radians(kFovYDeg) * 0.5f));
+        float modelScale = glm::length(glm::vec3(model[0]));
+        float cullDistanceLocal = fogEnabled ? fogEnd / modelScale : 0.0f;
+        wildTown.selectLods(eyeLocal, pixelsPerUnit, lodEnabled ? lodErrorPx : 0.0f);
+        wildTown.cullBeyond(eyeLocal, cullDistanceLocal);
+
+        impostors.select(eyeLocal, pixelsPerUnit, impostorsEnabled ? impostorPx : 0.0f, cullDistanceLocal);
+        wildTown.setClusterFades(impostors.getFades());
+    }
+
+    // lampi: grila de clustere depinde de view, proiectie si setul de lumini
+    if (dirty & (DIRTY_CAMERA | DIRTY_PROJECTION | DIRTY_MODEL | DIRTY_LIGHTING)) {
+        static const std::vector<gps::PointLight> noLights;
+        clusteredLights.build(view, enablePointLight ? pointLights : noLights);
+        clusteredLights.upload();
+    }
+}
+
 // =========================
-// RANDARE (2 PASS: umbre + normal)
+// RANDARE (umbre, apoi forward sau deferred, skybox la final)
 // =========================
 void renderScene()
 {
+    WT_PROFILE_FUNCTION();
+
+    gps::renderStats.reset();
+    gpuProfiler.beginFrame();
+
+    pumpSceneLoad();
+    if (!firstFrameReported) {
+        firstFrameReported = true;
+        std::cout << "[LOAD] first frame after " << (int)((glfwGetTime() - loadStartTime) * 1000.0) << " ms ("
+            << wildTown.getMeshCount() << " meshes on the GPU)\n";
+    }
+
+    // regiunea frame-ului trecut primeste un fence; alocarile de mai jos sunt ale acestui frame
+    streamBuffer.beginFrame();
+
+    // camera + lumini + ceata + clustere pentru toate pass-urile de mai jos
+    flushDirtyState();
+
+    // ce e in inel se rescrie in fiecare frame, murdar sau nu (doar o copie mica pe CPU)
+    cameraUBO.commitFrame();
+    lightingUBO.commitFrame();
+    fogUBO.commitFrame();
+    clusteredLights.commitFrame();
+
     // 1) PASS UMBRE
     // Forteaza solid in pass-ul de umbre (wireframe/points ar strica depth map-ul)
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-    computeLightSpaceMatrix();
-
     glViewport(0, 0, SHADOW_W, SHADOW_H);
     glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO);
     glClear(GL_DEPTH_BUFFER_BIT);
@@ -898,58 +1843,492 @@ void renderScene()
     glPolygonOffset(2.0f, 4.0f);
 
     shadowShader.useShaderProgram();
-    GLint lsLoc = glGetUniformLocation(shadowShader.shaderProgram, "lightSpaceMatrix");
-    GLint mLoc = glGetUniformLocation(shadowShader.shaderProgram, "model");
-    if (lsLoc != -1) glUniformMatrix4fv(lsLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
-    if (mLoc != -1) glUniformMatrix4fv(mLoc, 1, GL_FALSE, glm::value_ptr(model));
+    if (shadowModelLoc != -1) glUniformMatrix4fv(shadowModelLoc, 1, GL_FALSE, glm::value_ptr(model));
 
-    wildTown.Draw(shadowShader);
+    // doar pozitii: fara uniforme/texturi de material
+    {
+        gps::GpuProfiler::Scope gpuScope(gpuProfiler, "shadow");
+        wildTown.DrawDepth();
+    }
 
     glDisable(GL_POLYGON_OFFSET_FILL);
     glCullFace(GL_BACK);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
 
-    // 2) PASS NORMAL
-    glViewport(0, 0, retina_width, retina_height);
+    // stare comuna ambelor renderere: depth map-ul de umbre, clusterele de lampi
+    glActiveTexture(GL_TEXTURE3);
+    glBindTexture(GL_TEXTURE_2D, shadowDepthTex);
 
-    // Aplica modul de randare cerut doar pentru pass-ul normal
-    applyRenderModeForNormalPass();
+    // unit 4: aceeasi depth map, citita prin sampler-ul fara compare (PCSS)
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, shadowDepthTex);
+    glBindSampler(4, shadowRawSampler);
+    glActiveTexture(GL_TEXTURE0);
 
-    if (fogEnabled) glClearColor(fogColor.r, fogColor.g, fogColor.b, 1.0f);
-    else glClearColor(0.05f, 0.06f, 0.08f, 1.0f);
+    clusteredLights.bind(kClusterTexUnit);
 
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // 2) PASS NORMAL
+    if (gRenderer == RENDERER_DEFERRED) renderDeferredPasses();
+    else renderForwardPass();
 
+    // 3) SKYBOX ultimul: se umbresc doar pixelii de cer ramasi la depth = 1.0
     if (skyboxEnabled) {
-        setSkyboxFogUniforms();
-        skybox.Draw(skyboxShader, myCamera.getViewMatrix(), projection);
+        gps::GpuProfiler::Scope gpuScope(gpuProfiler, "skybox");
+        skybox.Draw(skyboxShader);
     }
 
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, shadowDepthTex);
+    gpuProfiler.endFrame();
+}
 
-    setSceneFogUniforms();
-    sceneShader.useShaderProgram();
+// consola + titlul ferestrei, o data pe secunda (valorile sunt de acum GpuProfiler::kFrameLatency frame-uri)
+static void updateGpuTimingOverlay(double now)
+{
+    if (!gpuTimingOverlay || now - gpuOverlayLastPrint < 1.0) return;
+    gpuOverlayLastPrint = now;
+
+    std::string summary = gpuProfiler.formatSummary();
+    std::cout << "[GPU] " << summary << "\n";
 
-    updateViewRelatedUniforms();
+    // titlul il pune thread-ul principal (applyPendingWindowTitle)
+    std::lock_guard<std::mutex> lock(windowTitleMutex);
+    pendingWindowTitle = std::string(kWindowTitle) + " - GPU " + summary;
+}
 
-    if (lightSpaceMatrixLoc != -1) {
-        glUniformMatrix4fv(lightSpaceMatrixLoc, 1, GL_FALSE, glm::value_ptr(lightSpaceMatrix));
+// thread-ul principal, dupa evenimente
+static void applyPendingWindowTitle()
+{
+    std::string title;
+    {
+        std::lock_guard<std::mutex> lock(windowTitleMutex);
+        title.swap(pendingWindowTitle);
     }
-    if (enableShadowsLoc != -1) {
-        glUniform1i(enableShadowsLoc, enableShadows ? 1 : 0);
+
+    // overlay-ul poate fi fost oprit (tasta 9) intre timp
+    if (!title.empty() && inputToggles.gpuTimingOverlay) glfwSetWindowTitle(glWindow, title.c_str());
+}
+
+// thread-ul de randare: detine contextul GL, deseneaza mereu ultimul FramePacket publicat
+static void renderThreadMain()
+{
+    WT_PROFILE_THREAD("render");
+
+    glfwMakeContextCurrent(glWindow);
+    glfwSwapInterval(vsyncEnabled ? 1 : 0);
+
+    while (!renderThreadStop) {
+        if (framePackets.acquire()) applyFramePacket(framePackets.readSlot());
+
+        renderScene();
+        updateGpuTimingOverlay(glfwGetTime());
+        {
+            WT_PROFILE_SCOPE("swapBuffers");
+            glfwSwapBuffers(glWindow);
+        }
     }
 
-    wildTown.Draw(sceneShader);
+    glfwMakeContextCurrent(NULL);
+}
+
+// =========================
+// BENCHMARK LUMINI (--bench-lights)
+// lumini sintetice in jurul pozitiei de start, timp de constructie a clusterelor + timp de frame
+// =========================
+static void runLightBenchmark()
+{
+    const int counts[] = { 8, 64, 256, 1024, 4096 };
+    const int warmupFrames = 10;
+    const int measuredFrames = 100;
+
+    // fara vsync, altfel timpul de frame e plafonat la rata monitorului
+    glfwSwapInterval(0);
+
+    // starea amanata (ex. DIRTY_MODEL) ar rescrie pointLights in timpul masuratorii
+    flushDirtyState();
+
+    std::vector<gps::PointLight> savedLights = pointLights;
+    unsigned int seed = 12345u;
+    auto rnd01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / 16777216.0f;
+    };
+
+    // primul rand: lampile reale din model, apoi seturi sintetice
+    std::vector<std::vector<gps::PointLight>> lightSets;
+    lightSets.push_back(savedLights);
+    for (int count : counts) {
+        std::vector<gps::PointLight> set;
+        for (int i = 0; i < count; i++) {
+            glm::vec3 p = kStartCamPos + glm::vec3((rnd01() - 0.5f) * 300.0f, 2.0f + rnd01() * 25.0f, (rnd01() - 0.5f) * 300.0f);
+            glm::vec3 c = glm::vec3(0.6f + 0.4f * rnd01(), 0.5f + 0.4f * rnd01(), 0.3f + 0.3f * rnd01());
+            set.push_back({ p, c, kPointLightRadius });
+        }
+        lightSets.push_back(set);
+    }
+
+    std::cout << "\n[BENCH LIGHTS] lights | cluster build ms | frame ms | max lights/cluster\n";
+
+    for (size_t setIndex = 0; setIndex < lightSets.size(); setIndex++) {
+        pointLights = lightSets[setIndex];
+
+        double buildMs = 0.0, frameMs = 0.0;
+        for (int f = 0; f < warmupFrames + measuredFrames; f++) {
+            // camera sta pe loc: forteaza reconstructia clusterelor, altfel nu s-ar masura nimic
+            markDirty(DIRTY_LIGHTING);
+
+            auto t0 = std::chrono::steady_clock::now();
+            renderScene();
+            glfwSwapBuffers(glWindow);
+            glFinish();
+            auto t1 = std::chrono::steady_clock::now();
+
+            if (f >= warmupFrames) {
+                buildMs += clusteredLights.getLastBuildMs();
+                frameMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            }
+        }
+
+        std::cout << "[BENCH LIGHTS] " << pointLights.size() << (setIndex == 0 ? " (model)" : "")
+            << " | " << buildMs / measuredFrames
+            << " | " << frameMs / measuredFrames
+            << " | " << clusteredLights.getMaxLightsInCluster() << "\n";
+    }
+
+    pointLights = savedLights;
+    markDirty(DIRTY_LIGHTING);
+}
+
+// =========================
+// BENCHMARK JOB SYSTEM (--bench-jobs)
+// aceeasi munca pe CPU (LOD + cull pe mesh-urile scenei, clusterele pentru 1024 de lampi)
+// cu 1, 2, 4, ... thread-uri; fara GPU, doar timpul de pe CPU
+// =========================
+static void runJobBenchmark()
+{
+    const int iterations = 200;
+    const int lightCount = 1024;
+
+    flushDirtyState();
+
+    // ocolim pozitia de start: distantele (deci LOD-urile si cull-ul) se schimba la fiecare iteratie
+    glm::mat4 inverseModel = glm::inverse(model);
+    float pixelsPerUnit = (float)retina_height / (2.0f * std::tan(glm::radians(kFovYDeg) * 0.5f));
+    float cullDistanceLocal = fogEnd / glm::length(glm::vec3(model[0]));
+
+    std::vector<glm::vec3> eyes;
+    std::vector<glm::mat4> views;
+    for (int i = 0; i < iterations; i++) {
+        float a = glm::radians(360.0f * (float)i / (float)iterations);
+        glm::vec3 eye = kStartCamPos + glm::vec3(std::cos(a) * 60.0f, 0.0f, std::sin(a) * 60.0f);
+        eyes.push_back(glm::vec3(inverseModel * glm::vec4(eye, 1.0f)));
+        views.push_back(glm::lookAt(eye, kStartCamPos, glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    unsigned int seed = 12345u;
+    auto rnd01 = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / 16777216.0f;
+    };
+    std::vector<gps::PointLight> lights;
+    for (int i = 0; i < lightCount; i++) {
+        glm::vec3 p = kStartCamPos + glm::vec3((rnd01() - 0.5f) * 300.0f, 2.0f + rnd01() * 25.0f, (rnd01() - 0.5f) * 300.0f);
+        lights.push_back({ p, glm::vec3(1.0f), kPointLightRadius });
+    }
+
+    int hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    std::vector<int> threadCounts;
+    for (int t = 1; t < hardwareThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(hardwareThreads);
+
+    std::cout << "\n[BENCH JOBS] threads | lod+cull ms | clusters ms | speedup lod+cull | speedup clusters\n";
+
+    double baseLodMs = 0.0, baseClusterMs = 0.0;
+    for (int threads : threadCounts) {
+        gps::JobSystem jobs(threads - 1);
+        wildTown.setJobSystem(&jobs);
+        clusteredLights.setJobSystem(&jobs);
+
+        double lodMs = 0.0, clusterMs = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            auto t0 = std::chrono::steady_clock::now();
+            wildTown.selectLods(eyes[i], pixelsPerUnit, lodErrorPx);
+            wildTown.cullBeyond(eyes[i], cullDistanceLocal);
+            auto t1 = std::chrono::steady_clock::now();
+            clusteredLights.build(views[i], lights);
+            auto t2 = std::chrono::steady_clock::now();
+
+            lodMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+            clusterMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        }
+        lodMs /= iterations;
+        clusterMs /= iterations;
+
+        if (threads == 1) {
+            baseLodMs = lodMs;
+            baseClusterMs = clusterMs;
+        }
+
+        std::cout << "[BENCH JOBS] " << threads
+            << " | " << lodMs
+            << " | " << clusterMs
+            << " | " << baseLodMs / std::max(lodMs, 1e-6)
+            << " | " << baseClusterMs / std::max(clusterMs, 1e-6) << "\n";
+    }
+
+    // workerii de mai sus dispar cu bucla; selectia se reface cu starea reala
+    wildTown.setJobSystem(jobSystem.get());
+    clusteredLights.setJobSystem(jobSystem.get());
+    markDirty(DIRTY_LOD | DIRTY_LIGHTING);
+}
+
+// =========================
+// BENCHMARK (--benchmark)
+// fara vsync; turul gTour avanseaza exact un pas fix de simulare per frame, deci fiecare rulare
+// randeaza aceleasi cadre. Raport: <prefix>.csv (per frame) + <prefix>.json (rezumat)
+// =========================
+struct BenchmarkFrame {
+    double frameMs;   // intre doua inceputuri de frame (include swap)
+    double cpuMs;     // simulare + inregistrarea comenzilor (pana la swap)
+    double gpuMs;     // GL_TIME_ELAPSED in jurul renderScene
+    unsigned long long drawCalls;
+    unsigned long long triangles;
+};
+
+// percentila (nearest rank) dintr-o copie sortata
+static double percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)values.size());
+    return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+static double average(const std::vector<double>& values)
+{
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / (double)values.size();
+}
+
+static void writeBenchmarkReport(const std::vector<BenchmarkFrame>& frames)
+{
+    std::vector<double> frameMs, cpuMs, gpuMs;
+    double drawCalls = 0.0, triangles = 0.0;
+    for (const auto& f : frames) {
+        frameMs.push_back(f.frameMs);
+        cpuMs.push_back(f.cpuMs);
+        gpuMs.push_back(f.gpuMs);
+        drawCalls += (double)f.drawCalls;
+        triangles += (double)f.triangles;
+    }
+    double n = frames.empty() ? 1.0 : (double)frames.size();
+
+    std::ofstream csv(benchmarkOut + ".csv");
+    csv << "frame,frame_ms,cpu_ms,gpu_ms,draw_calls,triangles\n";
+    for (size_t i = 0; i < frames.size(); i++) {
+        const BenchmarkFrame& f = frames[i];
+        csv << i << "," << f.frameMs << "," << f.cpuMs << "," << f.gpuMs << ","
+            << f.drawCalls << "," << f.triangles << "\n";
+    }
+
+    std::ofstream json(benchmarkOut + ".json");
+    json << "{\n"
+        << "  \"frames\": " << frames.size() << ",\n"
+        << "  \"resolution\": [" << retina_width << ", " << retina_height << "],\n"
+        << "  \"renderer\": \"" << (gRenderer == RENDERER_DEFERRED ? "deferred" : "forward") << "\",\n"
+        << "  \"shadow_filter\": \"" << shadowFilterName(gShadowFilter) << "\",\n"
+        << "  \"depth_prepass\": " << (depthPrepassEnabled ? "true" : "false") << ",\n"
+        << "  \"lod_error_px\": " << (lodEnabled ? lodErrorPx : 0.0f) << ",\n"
+        << "  \"impostor_px\": " << (impostorsEnabled ? impostorPx : 0.0f) << ",\n"
+        << "  \"vertex_format\": \"" << (gVertexFormat == gps::VERTEX_PACKED ? "packed" : "float") << "\",\n"
+        << "  \"frame_ms\": { \"avg\": " << average(frameMs)
+        << ", \"p50\": " << percentile(frameMs, 50.0)
+        << ", \"p95\": " << percentile(frameMs, 95.0)
+        << ", \"p99\": " << percentile(frameMs, 99.0) << " },\n"
+        << "  \"cpu_ms\": { \"avg\": " << average(cpuMs)
+        << ", \"p50\": " << percentile(cpuMs, 50.0)
+        << ", \"p95\": " << percentile(cpuMs, 95.0)
+        << ", \"p99\": " << percentile(cpuMs, 99.0) << " },\n"
+        << "  \"gpu_ms\": { \"avg\": " << average(gpuMs)
+        << ", \"p50\": " << percentile(gpuMs, 50.0)
+        << ", \"p95\": " << percentile(gpuMs, 95.0)
+        << ", \"p99\": " << percentile(gpuMs, 99.0) << " },\n"
+        << "  \"gpu_pass_ms_avg\": ";
+    gpuProfiler.writeJSON(json);
+    const gps::StreamBuffer::Stats& stream = streamBuffer.getStats();
+    json << ",\n"
+        << "  \"stream_buffer\": { \"persistent\": " << (streamBuffer.isPersistent() ? "true" : "false")
+        << ", \"stalls\": " << stream.stalls
+        << ", \"stall_ms\": " << stream.stallMs
+        << ", \"wraps\": " << stream.wraps
+        << ", \"failed\": " << stream.failed
+        << ", \"peak_frame_kb\": " << stream.peakFrameBytes / 1024.0 << " },\n"
+        << "  \"draw_calls_avg\": " << drawCalls / n << ",\n"
+        << "  \"triangles_avg\": " << triangles / n << "\n"
+        << "}\n";
+
+    std::cout << "\n[BENCHMARK] " << frames.size() << " frames, "
+        << (gRenderer == RENDERER_DEFERRED ? "deferred" : "forward") << "\n"
+        << "[BENCHMARK] frame ms avg " << average(frameMs)
+        << " | p50 " << percentile(frameMs, 50.0)
+        << " | p95 " << percentile(frameMs, 95.0)
+        << " | p99 " << percentile(frameMs, 99.0) << "\n"
+        << "[BENCHMARK] cpu ms avg " << average(cpuMs) << " | gpu ms avg " << average(gpuMs) << "\n"
+        << "[BENCHMARK] gpu passes: " << gpuProfiler.formatSummary() << "\n"
+        << "[BENCHMARK] draws " << drawCalls / n << " | triangles " << triangles / n << "\n"
+        << "[BENCHMARK] stream ring: " << stream.stalls << " stalls (" << stream.stallMs << " ms), "
+        << stream.wraps << " wraps, peak " << stream.peakFrameBytes / 1024.0 << " KB/frame\n"
+        << "[BENCHMARK] report: " << benchmarkOut << ".csv, " << benchmarkOut << ".json\n";
+}
+
+static void runBenchmark()
+{
+    const int warmupFrames = 30;
+
+    // intarziere de citire a query-urilor GPU (fara stall pe frame-ul curent)
+    const int kQueryLatency = 4;
+    GLuint timeQueries[kQueryLatency];
+    glGenQueries(kQueryLatency, timeQueries);
+
+    // acelasi punct de start ca la tasta P
+    autoDemo = true;
+    gTourIndex = 0;
+    gTourT = 0.0f;
+    myCamera.setPosition(kTourAnchorPos);
+    resetSimulationCamera();
+
+    benchmarkRunning = true;
+
+    int totalFrames = warmupFrames + benchmarkFrames;
+    std::vector<BenchmarkFrame> frames(totalFrames);
+
+    auto readGpuMs = [&](int frame) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(timeQueries[frame % kQueryLatency], GL_QUERY_RESULT, &ns);
+        frames[frame].gpuMs = (double)ns / 1.0e6;
+    };
+
+    auto frameStart = std::chrono::steady_clock::now();
+    int rendered = 0;
+    for (; rendered < totalFrames && !glfwWindowShouldClose(glWindow); rendered++) {
+        // slotul e refolosit: rezultatul de acum kQueryLatency frame-uri trebuie citit inainte
+        if (rendered >= kQueryLatency) readGpuMs(rendered - kQueryLatency);
+
+        // timpii pe pass-uri se numara doar dupa warm-up
+        if (rendered == warmupFrames) {
+            gpuProfiler.resetStats();
+            streamBuffer.resetStats();
+        }
+
+        // un pas fix per frame, fara interpolare: cadrul i e mereu acelasi
+        simulationStep((float)kSimStep);
+        resetSimulationCamera();
+
+        glBeginQuery(GL_TIME_ELAPSED, timeQueries[rendered % kQueryLatency]);
+        renderScene();
+        glEndQuery(GL_TIME_ELAPSED);
+
+        auto cpuEnd = std::chrono::steady_clock::now();
+        frames[rendered].cpuMs = std::chrono::duration<double, std::milli>(cpuEnd - frameStart).count();
+        frames[rendered].drawCalls = gps::renderStats.drawCalls;
+        frames[rendered].triangles = gps::renderStats.triangles;
+
+        glfwPollEvents();
+        glfwSwapBuffers(glWindow);
+
+        auto frameEnd = std::chrono::steady_clock::now();
+        frames[rendered].frameMs = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+        frameStart = frameEnd;
+    }
+
+    for (int f = std::max(0, rendered - kQueryLatency); f < rendered; f++) readGpuMs(f);
+    glDeleteQueries(kQueryLatency, timeQueries);
+
+    benchmarkRunning = false;
+
+    if (rendered <= warmupFrames) {
+        std::cout << "[BENCHMARK] aborted during warm-up, no report\n";
+        return;
+    }
+    frames.resize(rendered);
+    frames.erase(frames.begin(), frames.begin() + warmupFrames);
+    writeBenchmarkReport(frames);
+}
+
+// =========================
+// RANDARE OFFSCREEN (--render-poses)
+// =========================
+static bool loadRenderPoses(const std::string& path, std::vector<CameraState>& poses)
+{
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream ss(line);
+        glm::vec3 pos, target;
+        if (!(ss >> pos.x >> pos.y >> pos.z >> target.x >> target.y >> target.z)) continue;
+        if (glm::length(target - pos) < 1e-4f) continue;
+
+        poses.push_back({ pos, glm::normalize(target - pos) });
+    }
+    return !poses.empty();
+}
+
+static void runOffscreenRender()
+{
+    std::vector<CameraState> poses;
+    if (!loadRenderPoses(renderPosesFile, poses)) {
+        std::cout << "[RENDER] no camera poses in " << renderPosesFile << "\n";
+        return;
+    }
+
+    const char* extension = renderFormat == gps::FrameCapture::FORMAT_PNG ? ".png" : ".ppm";
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < poses.size(); i++) {
+        renderCamPos = poses[i].position;
+        renderCamFront = poses[i].front;
+        markDirty(DIRTY_CAMERA);
+
+        renderScene();
+
+        // citirea e doar pusa in coada; fisierul e scris cateva cadre mai tarziu
+        char index[16];
+        std::snprintf(index, sizeof(index), "%05d", (int)i);
+        frameCapture.capture(renderOut + index + extension, renderFormat);
+    }
+    frameCapture.finish();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    size_t written = frameCapture.getFramesWritten();
+    std::cout << "[RENDER] " << written << " frames " << retina_width << "x" << retina_height
+        << " in " << seconds << " s (" << (seconds > 0.0 ? written / seconds : 0.0) << " frames/s to disk)"
+        << " | readback stalls " << frameCapture.getStallMs() << " ms\n";
 }
 
 void cleanup()
 {
+#if defined(WT_PROFILING)
+    if (!traceOut.empty()) WT_PROFILE_EXPORT(traceOut);
+#endif
+
     // opreste muzica daca ruleaza
     stopMusic();
 
+    if (shadowRawSampler) glDeleteSamplers(1, &shadowRawSampler);
     if (shadowDepthTex) glDeleteTextures(1, &shadowDepthTex);
     if (shadowFBO) glDeleteFramebuffers(1, &shadowFBO);
+    if (fullscreenVAO) glDeleteVertexArrays(1, &fullscreenVAO);
+    streamBuffer.release();
+    frameCapture.release();
+    gpuProfiler.release();
+
+    // loader-ul trimite decodarile texturilor pe job system
+    wildTown.cancelLoad();
+    jobSystem.reset();
 
     glfwDestroyWindow(glWindow);
     glfwTerminate();
@@ -957,39 +2336,170 @@ void cleanup()
 
 int main(int argc, const char* argv[])
 {
+    WT_PROFILE_THREAD("main");
+
+    bool benchLights = false;
+    bool benchJobs = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--deferred") == 0) gRenderer = RENDERER_DEFERRED;
+        if (std::strcmp(argv[i], "--bench-lights") == 0) benchLights = true;
+        if (std::strcmp(argv[i], "--bench-jobs") == 0) benchJobs = true;
+        if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) jobWorkers = std::max(0, std::atoi(argv[++i]));
+        if (std::strcmp(argv[i], "--no-vsync") == 0) vsyncEnabled = false;
+        if (std::strcmp(argv[i], "--no-render-thread") == 0) renderThreadEnabled = false;
+        if (std::strcmp(argv[i], "--sync-load") == 0) asyncSceneLoad = false;
+        if (std::strcmp(argv[i], "--no-persistent-map") == 0) persistentMapEnabled = false;
+        if (std::strcmp(argv[i], "--benchmark") == 0) benchmarkMode = true;
+        if (std::strcmp(argv[i], "--benchmark-frames") == 0 && i + 1 < argc) benchmarkFrames = std::max(1, std::atoi(argv[++i]));
+        if (std::strcmp(argv[i], "--benchmark-out") == 0 && i + 1 < argc) benchmarkOut = argv[++i];
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) traceOut = argv[++i];
+        if (std::strcmp(argv[i], "--headless") == 0) headlessMode = true;
+        if (std::strcmp(argv[i], "--osmesa") == 0) headlessMode = headlessOSMesa = true;
+        if (std::strcmp(argv[i], "--packed-vertices") == 0) gVertexFormat = gps::VERTEX_PACKED;
+        if (std::strcmp(argv[i], "--shadow-taps") == 0 && i + 1 < argc)
+            gShadowFilter = std::atoi(argv[++i]) >= 16 ? SF_POISSON_16 : SF_POISSON;
+        if (std::strcmp(argv[i], "--no-lod") == 0) lodEnabled = false;
+        if (std::strcmp(argv[i], "--lod-error") == 0 && i + 1 < argc) lodErrorPx = (float)std::atof(argv[++i]);
+        if (std::strcmp(argv[i], "--no-impostors") == 0) impostorsEnabled = false;
+        if (std::strcmp(argv[i], "--impostor-px") == 0 && i + 1 < argc) impostorPx = (float)std::atof(argv[++i]);
+        if (std::strcmp(argv[i], "--render-poses") == 0 && i + 1 < argc) {
+            renderPosesFile = argv[++i];
+            headlessMode = true;
+        }
+        if (std::strcmp(argv[i], "--render-out") == 0 && i + 1 < argc) renderOut = argv[++i];
+        if (std::strcmp(argv[i], "--render-size") == 0 && i + 1 < argc) {
+            int w = 0, h = 0;
+            if (std::sscanf(argv[++i], "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+                glWindowWidth = w;
+                glWindowHeight = h;
+            }
+        }
+        if (std::strcmp(argv[i], "--render-format") == 0 && i + 1 < argc)
+            renderFormat = std::strcmp(argv[++i], "png") == 0 ? gps::FrameCapture::FORMAT_PNG : gps::FrameCapture::FORMAT_PPM;
+    }
+
+    // throughput real: fara plafonul de refresh al monitorului
+    if (benchmarkMode) vsyncEnabled = false;
+
+    // masuratorile si capturile au nevoie de scena completa din primul frame
+    if (benchmarkMode || headlessMode || benchLights || benchJobs) asyncSceneLoad = false;
+
+#if !defined(WT_PROFILING)
+    if (!traceOut.empty()) std::cout << "[PROFILER] --trace ignored: built without WT_PROFILING\n";
+#endif
+
+    jobSystem = std::make_unique<gps::JobSystem>(jobWorkers);
+
     if (!initOpenGLWindow()) return 1;
+    if (headlessMode && !initOffscreenTarget()) {
+        cleanup();
+        return 1;
+    }
 
     initOpenGLState();
 
     initShadowMap();
 
     initObjects();
+    initUniformBuffers();
     initShaders();
     initUniforms();
 
+    // --sync-load: modelul e deja pe GPU, impostorii se coc acum; altfel prima parte a incarcarii
+    pumpSceneLoad();
+    if (sceneLoadFailed) {
+        cleanup();
+        return 1;
+    }
+
     // NOU: asigura ca pornim exact din pozitia camerei dorita
     myCamera.setPosition(kStartCamPos);
     applyGroundClamp();
-    updateViewRelatedUniforms();
+    resetSimulationCamera();
+
+    if (!renderPosesFile.empty()) {
+        runOffscreenRender();
+        cleanup();
+        return 0;
+    }
+
+    if (benchLights) {
+        runLightBenchmark();
+        cleanup();
+        return 0;
+    }
+
+    if (benchJobs) {
+        runJobBenchmark();
+        cleanup();
+        return 0;
+    }
+
+    if (benchmarkMode) {
+        runBenchmark();
+        cleanup();
+        return 0;
+    }
+
+    // de aici inputul scrie doar in starea simularii; randarea o primeste prin FramePacket
+    inputToggles = captureRenderToggles();
+    inputFramebufferWidth = retina_width;
+    inputFramebufferHeight = retina_height;
 
     lastFrameTime = glfwGetTime();
 
-    while (!glfwWindowShouldClose(glWindow)) {
+    if (renderThreadEnabled) {
+        buildFramePacket(framePackets.writeSlot());
+        framePackets.publish();
 
-        double now = glfwGetTime();
-        float dt = (float)(now - lastFrameTime);
-        lastFrameTime = now;
+        // contextul GL trece pe thread-ul de randare
+        glfwMakeContextCurrent(NULL);
+        std::thread renderThread(renderThreadMain);
 
-        // P activeaza/dezactiveaza autoDemo; cand e activ, rulam turul cinematic
-        if (autoDemo) runCinematicTour(dt);
-        else processMovement();
+        while (!glfwWindowShouldClose(glWindow)) {
+            // evenimentele raman pe thread-ul principal (cerinta GLFW)
+            glfwWaitEventsTimeout(kSimStep);
 
-        renderScene();
+            double now = glfwGetTime();
+            double frameDt = now - lastFrameTime;
+            lastFrameTime = now;
 
-        glfwPollEvents();
-        glfwSwapBuffers(glWindow);
+            advanceSimulation(frameDt);
+            buildFramePacket(framePackets.writeSlot());
+            framePackets.publish();
+
+            applyPendingWindowTitle();
+        }
+
+        renderThreadStop = true;
+        renderThread.join();
+        glfwMakeContextCurrent(glWindow);
+    }
+    else {
+        FramePacket packet;
+
+        while (!glfwWindowShouldClose(glWindow)) {
+
+            double now = glfwGetTime();
+            double frameDt = now - lastFrameTime;
+            lastFrameTime = now;
+
+            advanceSimulation(frameDt);
+            buildFramePacket(packet);
+            applyFramePacket(packet);
+
+            renderScene();
+            updateGpuTimingOverlay(now);
+            applyPendingWindowTitle();
+
+            glfwPollEvents();
+            {
+                WT_PROFILE_SCOPE("swapBuffers");
+                glfwSwapBuffers(glWindow);
+            }
+        }
     }
 
     cleanup();
-    return 0;
+    return sceneLoadFailed ? 1 : 0;
 }
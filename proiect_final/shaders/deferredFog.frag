@@ -0,0 +1,25 @@
+#version 410 core
+
+// ceata ca post pass: blending peste rezultatul iluminat
+// (mix(fogColor, color, f) == color * f + fogColor * (1 - f), adica alpha = 1 - f)
+
+uniform sampler2D gDepth;
+
+// invProjection: CameraBlock; fogColor, fogStart, fogEnd: FogBlock
+#include "uniformBlocks.glsl"
+
+out vec4 fColor;
+
+void main()
+{
+    ivec2 px = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, px, 0).r;
+    if (depth >= 1.0) discard;
+
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(gDepth, 0));
+    vec4 eye = invProjection * vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    float d = length(eye.xyz / eye.w);
+
+    float fogFactor = clamp((fogEnd - d) / (fogEnd - fogStart), 0.0, 1.0);
+    fColor = vec4(fogColor, 1.0 - fogFactor);
+}
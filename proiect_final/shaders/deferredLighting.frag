@@ -0,0 +1,41 @@
+#version 410 core
+
+// pass full-screen: directional + umbre + lampi (clustere), citind G-buffer-ul
+
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+
+// invProjection, invView, lightSpaceMatrix: CameraBlock
+#include "uniformBlocks.glsl"
+#include "lighting.glsl"
+
+out vec4 fColor;
+
+vec3 EyePositionFromDepth(vec2 uv, float depth)
+{
+    vec4 ndc = vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 eye = invProjection * ndc;
+    return eye.xyz / eye.w;
+}
+
+void main()
+{
+    ivec2 px = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, px, 0).r;
+
+    // cer: ramane neatins pentru skybox / culoarea de clear
+    if (depth >= 1.0) discard;
+
+    vec3 albedo = texelFetch(gAlbedo, px, 0).rgb;
+    vec3 N = normalize(texelFetch(gNormal, px, 0).xyz);
+
+    vec2 uv = gl_FragCoord.xy / vec2(textureSize(gDepth, 0));
+    vec3 P = EyePositionFromDepth(uv, depth);
+
+    vec4 posLightSpace = lightSpaceMatrix * (invView * vec4(P, 1.0));
+    fColor = vec4(ShadeScene(P, N, albedo, posLightSpace), 1.0);
+
+    // adancimea scenei ajunge in framebuffer-ul final (skybox-ul testeaza GL_LEQUAL)
+    gl_FragDepth = depth;
+}
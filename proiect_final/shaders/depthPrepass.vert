@@ -0,0 +1,21 @@
+#version 410 core
+
+layout(location=0) in vec3 vPosition;
+
+uniform mat4 model;
+
+// view, projection: CameraBlock
+#include "uniformBlocks.glsl"
+#include "vertexFormat.glsl"
+
+// IMPORTANT: pass-ul principal ruleaza cu GL_EQUAL, deci pozitia trebuie
+// calculata EXACT ca in shaderPPL.vert (aceleasi operatii, aceeasi ordine)
+invariant gl_Position;
+
+void main()
+{
+    vec4 posWorld = model * (vInstanceMatrix * vec4(decodePosition(vPosition), 1.0));
+    vec4 posEye = view * posWorld;
+
+    gl_Position = projection * posEye;
+}
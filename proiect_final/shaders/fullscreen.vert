@@ -0,0 +1,11 @@
+#version 410 core
+
+// un singur triunghi care acopera tot ecranul: (-1,-1), (3,-1), (-1,3)
+// (fara atribute, se deseneaza cu un VAO gol si glDrawArrays(GL_TRIANGLES, 0, 3))
+void main()
+{
+    vec2 ndc = vec2((gl_VertexID == 1) ? 3.0 : -1.0,
+                    (gl_VertexID == 2) ? 3.0 : -1.0);
+
+    gl_Position = vec4(ndc, 0.0, 1.0);
+}
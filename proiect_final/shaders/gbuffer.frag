@@ -0,0 +1,33 @@
+#version 410 core
+
+// pass-ul de geometrie al renderer-ului deferred (vertex shader: shaderPPL.vert)
+
+in vec3 fragPosEye;
+in vec3 fragNormalEye;
+in vec2 fragTexCoords;
+in vec4 fragPosLightSpace;
+
+uniform vec3 baseColor;
+uniform sampler2D diffuseTexture;
+uniform int hasDiffuseTex;
+
+// mesh-urile unui cluster care trece pe impostor (Model3D::DrawFading)
+#ifdef LOD_FADE
+#include "lodFade.glsl"
+uniform float lodFade;
+#endif
+
+layout(location=0) out vec4 gAlbedo;
+layout(location=1) out vec4 gNormal;   // eye space
+
+void main()
+{
+#ifdef LOD_FADE
+    if (LodFadeThreshold() < lodFade) discard;
+#endif
+
+    vec3 albedo = (hasDiffuseTex == 1) ? texture(diffuseTexture, fragTexCoords).rgb : baseColor;
+
+    gAlbedo = vec4(albedo, 1.0);
+    gNormal = vec4(normalize(fragNormalEye), 0.0);
+}
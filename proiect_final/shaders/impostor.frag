@@ -0,0 +1,132 @@
+#version 410 core
+
+// impostorul unui cluster: 4 cadre vecine din atlas amestecate biliniar, punctul de pe suprafata
+// refacut din adancimea coapta (gl_FragDepth), apoi aceeasi iluminare ca geometria
+// IMPOSTOR_GBUFFER: varianta pentru pass-ul de geometrie al renderer-ului deferred
+
+in vec3 fragPosLocal;
+flat in vec4 clusterSphere;
+flat in float clusterLayer;
+flat in float clusterFade;
+flat in ivec2 frame0;
+flat in vec2 frameBlend;
+
+uniform sampler2DArray impostorAlbedo;       // rgb * acoperire, a = acoperire
+uniform sampler2DArray impostorNormalDepth;  // (normala MODEL * 0.5 + 0.5, adancime) * acoperire
+
+uniform vec3 eyeLocal;
+uniform mat4 model;
+uniform mat3 normalMatrix;
+
+// view, projection, lightSpaceMatrix: CameraBlock
+#include "uniformBlocks.glsl"
+#include "impostorFrames.glsl"
+#include "lodFade.glsl"
+
+#ifdef IMPOSTOR_GBUFFER
+layout(location=0) out vec4 gAlbedo;
+layout(location=1) out vec4 gNormal;   // eye space
+#else
+#include "lighting.glsl"
+out vec4 fColor;
+#endif
+
+// coordonatele in cadru (0..1) ale punctului unde raza taie planul perpendicular pe D aflat la
+// distanta offset de centru (offset = r * (1 - 2 * adancime), adancimea coapta fiind 0..1)
+vec2 FrameUV(vec3 rayDir, float rd, vec3 D, vec3 R, vec3 U, float offset)
+{
+    float t = (dot(clusterSphere.xyz - eyeLocal, D) + offset) / rd;
+    vec3 p = eyeLocal + rayDir * t - clusterSphere.xyz;
+    return vec2(dot(p, R), dot(p, U)) / clusterSphere.w * 0.5 + 0.5;
+}
+
+vec3 AtlasUV(ivec2 f, vec2 uv)
+{
+    return vec3((vec2(f) + clamp(uv, 0.0, 1.0)) / float(IMPOSTOR_FRAMES), clusterLayer);
+}
+
+// un cadru: raza camerei intersectata cu planul cadrului prin centru, apoi un pas de paralaxa
+// (planul de la adancimea gasita acolo); adancimea finala devine parametrul t de-a lungul razei
+// (fara return-uri inainte de texture(): derivatele trebuie sa ramana in control flow uniform)
+void AddFrame(ivec2 f, float w, vec3 rayDir,
+              inout vec4 albedoSum, inout vec3 normalSum, inout float tSum)
+{
+    vec3 D = HemiOctDecode(vec2(f) / float(IMPOSTOR_FRAMES - 1));
+    vec3 R, U;
+    FrameBasis(D, R, U);
+
+    vec3 c = clusterSphere.xyz;
+    float r = clusterSphere.w;
+    float rd = min(dot(rayDir, D), -1e-4);
+
+    // fara acoperire in primul punct: ramane planul prin centru (adancime 0.5)
+    vec2 uv = FrameUV(rayDir, rd, D, R, U, 0.0);
+    float firstCoverage = texture(impostorAlbedo, AtlasUV(f, uv)).a;
+    float firstDepth = texture(impostorNormalDepth, AtlasUV(f, uv)).a;
+    firstDepth = firstCoverage > 0.0 ? firstDepth / firstCoverage : 0.5;
+    uv = FrameUV(rayDir, rd, D, R, U, r * (1.0 - 2.0 * firstDepth));
+
+    vec3 atlasUV = AtlasUV(f, uv);
+    vec4 albedo = texture(impostorAlbedo, atlasUV);
+    vec4 normalDepth = texture(impostorNormalDepth, atlasUV);
+
+    // in afara cadrului: nicio acoperire
+    bool inside = all(greaterThanEqual(uv, vec2(0.0))) && all(lessThanEqual(uv, vec2(1.0)));
+    w = inside ? w : 0.0;
+
+    float coverage = albedo.a;
+    float depth = normalDepth.a / max(coverage, 1e-4);
+    float t = (dot(c - eyeLocal, D) + r * (1.0 - 2.0 * depth)) / rd;
+
+    albedoSum += w * albedo;
+    normalSum += w * (normalDepth.rgb * 2.0 - coverage);
+    tSum += w * coverage * t;
+}
+
+void main()
+{
+    vec3 rayDir = fragPosLocal - eyeLocal;
+
+    vec4 albedoSum = vec4(0.0);
+    vec3 normalSum = vec3(0.0);
+    float tSum = 0.0;
+
+    float bx = frameBlend.x;
+    float by = frameBlend.y;
+    AddFrame(frame0,              (1.0 - bx) * (1.0 - by), rayDir, albedoSum, normalSum, tSum);
+    AddFrame(frame0 + ivec2(1, 0), bx * (1.0 - by),        rayDir, albedoSum, normalSum, tSum);
+    AddFrame(frame0 + ivec2(0, 1), (1.0 - bx) * by,        rayDir, albedoSum, normalSum, tSum);
+    AddFrame(frame0 + ivec2(1, 1), bx * by,                rayDir, albedoSum, normalSum, tSum);
+
+    float coverage = albedoSum.a;
+    if (coverage < 0.5) discard;
+
+    // cross-fade cu geometria (complementar cu LOD_FADE din shaderPPL.frag / gbuffer.frag)
+    if (LodFadeThreshold() >= clusterFade) discard;
+
+    vec3 albedo = albedoSum.rgb / coverage;
+    vec3 normalLocal = normalize(normalSum);
+    vec3 posLocal = eyeLocal + rayDir * (tSum / coverage);
+
+    vec4 posWorld = model * vec4(posLocal, 1.0);
+    vec4 posEye = view * posWorld;
+    vec4 posClip = projection * posEye;
+    gl_FragDepth = posClip.z / posClip.w * 0.5 + 0.5;
+
+    vec3 N = normalize(mat3(view) * (normalMatrix * normalLocal));
+
+#ifdef IMPOSTOR_GBUFFER
+    gAlbedo = vec4(albedo, 1.0);
+    gNormal = vec4(N, 0.0);
+#else
+    vec3 color = ShadeScene(posEye.xyz, N, albedo, lightSpaceMatrix * posWorld);
+
+    if (fogEnabled == 1) {
+        float d = length(posEye.xyz);
+        float fogFactor = clamp((fogEnd - d) / (fogEnd - fogStart), 0.0, 1.0);
+        color = mix(fogColor, color, fogFactor);
+    }
+
+    fColor = vec4(color, 1.0);
+#endif
+}
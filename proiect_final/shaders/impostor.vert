@@ -0,0 +1,55 @@
+#version 410 core
+
+// un quad per cluster, orientat spre camera (gps::ImpostorAtlas::Draw, o singura desenare instantiata)
+// colturile vin din gl_VertexID (triangle strip), clusterul din atributele per instanta
+
+layout(location=0) in vec4 instSphere;      // centru + raza, coordonate MODEL
+layout(location=1) in vec2 instLayerFade;   // layer in atlas, fade (0..1)
+
+uniform mat4 model;
+uniform vec3 eyeLocal;                      // camera in coordonate MODEL
+
+// view, projection: CameraBlock
+#include "uniformBlocks.glsl"
+#include "impostorFrames.glsl"
+
+out vec3 fragPosLocal;
+flat out vec4 clusterSphere;
+flat out float clusterLayer;
+flat out float clusterFade;
+flat out ivec2 frame0;      // cele 4 cadre amestecate: frame0 .. frame0 + (1, 1)
+flat out vec2 frameBlend;
+
+void main()
+{
+    vec2 corner = vec2((gl_VertexID & 1) != 0 ? 1.0 : -1.0, (gl_VertexID & 2) != 0 ? 1.0 : -1.0);
+
+    vec3 center = instSphere.xyz;
+    float radius = instSphere.w;
+
+    vec3 toEye = eyeLocal - center;
+    float dist = length(toEye);
+    toEye /= dist;
+
+    // "sus"-ul camerei in coordonate MODEL (view * model = rotatie * scala uniforma)
+    mat3 viewModel = mat3(view) * mat3(model);
+    vec3 cameraUp = vec3(viewModel[0][1], viewModel[1][1], viewModel[2][1]);
+
+    // quad perpendicular pe directia spre camera, cat silueta sferei in planul centrului
+    vec3 right = normalize(cross(cameraUp, toEye));
+    vec3 up = cross(toEye, right);
+    float halfSize = radius * dist / sqrt(max(dist * dist - radius * radius, 1e-6));
+
+    fragPosLocal = center + (right * corner.x + up * corner.y) * halfSize;
+
+    // sub orizont: cadrele de pe orizont
+    vec2 grid = HemiOctEncode(vec3(toEye.x, max(toEye.y, 0.0), toEye.z)) * float(IMPOSTOR_FRAMES - 1);
+    frame0 = clamp(ivec2(floor(grid)), ivec2(0), ivec2(IMPOSTOR_FRAMES - 2));
+    frameBlend = clamp(grid - vec2(frame0), 0.0, 1.0);
+
+    clusterSphere = instSphere;
+    clusterLayer = instLayerFade.x;
+    clusterFade = instLayerFade.y;
+
+    gl_Position = projection * view * model * vec4(fragPosLocal, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 410 core
+
+// atlasul impostorilor: albedo + (normala MODEL, adancime) pe doua texture array-uri
+// texelii goi raman 0 (alpha 0), vezi gps::ImpostorAtlas
+
+in vec3 fragNormalLocal;
+in vec2 fragTexCoords;
+
+uniform vec3 baseColor;
+uniform sampler2D diffuseTexture;
+uniform int hasDiffuseTex;
+
+layout(location=0) out vec4 outAlbedo;
+layout(location=1) out vec4 outNormalDepth;
+
+void main()
+{
+    vec3 albedo = (hasDiffuseTex == 1) ? texture(diffuseTexture, fragTexCoords).rgb : baseColor;
+
+    // proiectie ortografica: gl_FragCoord.z e liniar in lungul axei cadrului
+    outAlbedo = vec4(albedo, 1.0);
+    outNormalDepth = vec4(normalize(fragNormalLocal) * 0.5 + 0.5, gl_FragCoord.z);
+}
@@ -0,0 +1,23 @@
+#version 410 core
+
+// coacerea impostorilor (gps::ImpostorAtlas::bake): un cadru ortografic al unui cluster,
+// totul in coordonate MODEL (fara CameraBlock)
+
+layout(location=0) in vec3 vPosition;
+layout(location=1) in vec3 vNormal;
+layout(location=2) in vec2 vTexCoords;
+
+uniform mat4 bakeViewProjection;
+
+#include "vertexFormat.glsl"
+
+out vec3 fragNormalLocal;
+out vec2 fragTexCoords;
+
+void main()
+{
+    fragNormalLocal = mat3(vInstanceMatrix) * vNormal;
+    fragTexCoords = vTexCoords;
+
+    gl_Position = bakeViewProjection * (vInstanceMatrix * vec4(decodePosition(vPosition), 1.0));
+}
@@ -0,0 +1,36 @@
+// =========================
+// CADRELE IMPOSTORILOR (hemi-octaedric, vezi gps::ImpostorAtlas)
+// cadrul (i, j) priveste clusterul din directia HemiOctDecode((i, j) / (IMPOSTOR_FRAMES - 1));
+// marginile grilei sunt orizontul, centrul e deasupra
+// IMPOSTOR_FRAMES vine din aplicatie (= ImpostorAtlas::kFramesPerSide)
+// =========================
+#ifndef IMPOSTOR_FRAMES_GLSL
+#define IMPOSTOR_FRAMES_GLSL
+
+#ifndef IMPOSTOR_FRAMES
+#define IMPOSTOR_FRAMES 8
+#endif
+
+// directie (y >= 0) -> grila [0, 1]^2
+vec2 HemiOctEncode(vec3 d)
+{
+    d /= max(abs(d.x) + abs(d.y) + abs(d.z), 1e-6);
+    return vec2(d.x + d.z, d.x - d.z) * 0.5 + 0.5;
+}
+
+vec3 HemiOctDecode(vec2 g)
+{
+    vec2 uv = g * 2.0 - 1.0;
+    float x = 0.5 * (uv.x + uv.y);
+    float z = 0.5 * (uv.x - uv.y);
+    return normalize(vec3(x, 1.0 - abs(x) - abs(z), z));
+}
+
+// axele cadrului (aceleasi ca glm::lookAt din ImpostorAtlas::bake)
+void FrameBasis(vec3 D, out vec3 R, out vec3 U)
+{
+    R = normalize(cross(vec3(0.0, 1.0, 0.0), D));
+    U = cross(D, R);
+}
+
+#endif
@@ -0,0 +1,223 @@
+// =========================
+// ILUMINARE COMUNA (forward: shaderPPL.frag, deferred: deferredLighting.frag)
+// inclusa cu #include (rezolvat de Shader::readShaderFile)
+// =========================
+
+// lightDir, lightColor, numPointLights, enableShadows: LightingBlock
+#include "uniformBlocks.glsl"
+
+// =========================
+// POINT LIGHTS (clustered forward, vezi ClusteredLights.cpp)
+// =========================
+uniform samplerBuffer  pointLights;          // 2 texeli / lumina: (posEye, radius), (color, 0)
+uniform usamplerBuffer clusterGrid;          // 1 texel / cluster: (offset, count)
+uniform usamplerBuffer clusterLightIndices;  // indici de lumini, concatenati pe clustere
+
+uniform ivec3 clusterDims;        // tiles X, tiles Y, slices Z
+uniform vec2 clusterTileSize;     // pixeli, pe x si pe y
+uniform float clusterNearSliceZ;  // slice 0 = [near, clusterNearSliceZ]
+uniform float clusterLogScale;    // (slices - 1) / log(clusterFar / clusterNearSliceZ)
+
+// =========================
+// SHADOWS
+// =========================
+// SHADOW_FILTER vine din aplicatie (Shader::loadShader cu defines, tasta F):
+// 0 = hardware 2x2 (un singur fetch, compare + GL_LINEAR)
+// 1 = disc Poisson rotit per pixel (POISSON_TAPS fetch-uri hardware 2x2)
+// 2 = PCSS (blocker search + Poisson cu raza variabila)
+// POISSON_TAPS vine tot din aplicatie: 8 implicit (ca vechiul PCF 3x3), 16 la cerere
+#define SHADOW_FILTER_HARDWARE 0
+#define SHADOW_FILTER_POISSON  1
+#define SHADOW_FILTER_PCSS     2
+
+#ifndef SHADOW_FILTER
+#define SHADOW_FILTER SHADOW_FILTER_POISSON
+#endif
+
+#ifndef POISSON_TAPS
+#define POISSON_TAPS 8
+#endif
+
+uniform sampler2DShadow shadowMap; // depth map cu GL_COMPARE_REF_TO_TEXTURE
+
+#if SHADOW_FILTER == SHADOW_FILTER_PCSS
+// aceeasi textura, dar legata cu un sampler fara compare (adancimi brute)
+uniform sampler2D shadowDepthMap;
+#endif
+
+// raze in texeli ale shadow map-ului
+#define POISSON_RADIUS       2.0
+#define PCSS_SEARCH_RADIUS   8.0
+#define PCSS_PENUMBRA_SCALE  400.0  // texeli de penumbra per unitate de adancime (ortho)
+#define PCSS_MAX_RADIUS      12.0
+
+#if SHADOW_FILTER != SHADOW_FILTER_HARDWARE
+// primele 8 puncte sunt ele insele un disc Poisson (distanta minima maxima, centrate),
+// deci POISSON_TAPS = 8 foloseste doar prima jumatate
+const vec2 poissonDisk[16] = vec2[](
+    vec2( 0.94558609, -0.76890725), vec2(-0.09418410, -0.92938870),
+    vec2(-0.81544232, -0.87912464), vec2(-0.38277543,  0.27676845),
+    vec2( 0.97484398,  0.75648379), vec2(-0.81409955,  0.91437590),
+    vec2( 0.19984126,  0.78641367), vec2( 0.14383161, -0.14100790),
+    vec2(-0.94201624, -0.39906216), vec2( 0.34495938,  0.29387760),
+    vec2(-0.91588581,  0.45771432), vec2( 0.44323325, -0.97511554),
+    vec2( 0.53742981, -0.47373420), vec2(-0.26496911, -0.41893023),
+    vec2( 0.79197514,  0.19090188), vec2(-0.24188840,  0.99706507)
+);
+
+// rotatie per pixel a discului (transforma banding-ul in zgomot fin)
+mat2 PoissonRotation()
+{
+    float n = fract(52.9829189 * fract(dot(gl_FragCoord.xy, vec2(0.06711056, 0.00583715))));
+    float a = 6.28318530718 * n;
+    float c = cos(a);
+    float s = sin(a);
+    return mat2(c, s, -s, c);
+}
+
+// fiecare fetch din sampler2DShadow face deja PCF 2x2 in hardware
+float PoissonLit(vec3 projCoords, float ref, float radiusTexels, vec2 texelSize)
+{
+    mat2 rot = PoissonRotation();
+    float lit = 0.0;
+    for (int i = 0; i < POISSON_TAPS; i++) {
+        vec2 offset = rot * poissonDisk[i] * radiusTexels * texelSize;
+        lit += texture(shadowMap, vec3(projCoords.xy + offset, ref));
+    }
+    return lit / float(POISSON_TAPS);
+}
+#endif
+
+float ShadowFactor(vec4 fragPosLS, vec3 N, vec3 Ld)
+{
+    // perspective divide
+    vec3 projCoords = fragPosLS.xyz / fragPosLS.w;
+    // to [0,1]
+    projCoords = projCoords * 0.5 + 0.5;
+
+    // daca e in afara shadow map (xy), nu umbrim
+    if (projCoords.x < 0.0 || projCoords.x > 1.0 ||
+        projCoords.y < 0.0 || projCoords.y > 1.0)
+        return 0.0;
+
+    // daca e dincolo de far plane-ul luminii
+    if (projCoords.z > 1.0) return 0.0;
+    if (projCoords.z < 0.0) return 0.0;
+
+    // bias (reduce shadow acne)
+    float bias = max(0.0025 * (1.0 - dot(N, Ld)), 0.0008);
+    float ref = projCoords.z - bias;
+
+#if SHADOW_FILTER == SHADOW_FILTER_HARDWARE
+    float lit = texture(shadowMap, vec3(projCoords.xy, ref));
+#else
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
+
+#if SHADOW_FILTER == SHADOW_FILTER_PCSS
+    // 1) blocker search: media adancimilor mai apropiate de lumina decat fragmentul
+    mat2 rot = PoissonRotation();
+    float blockerSum = 0.0;
+    float blockers = 0.0;
+    for (int i = 0; i < 16; i++) {
+        vec2 offset = rot * poissonDisk[i] * PCSS_SEARCH_RADIUS * texelSize;
+        float d = texture(shadowDepthMap, projCoords.xy + offset).r;
+        if (d < ref) {
+            blockerSum += d;
+            blockers += 1.0;
+        }
+    }
+    if (blockers == 0.0) return 0.0;
+
+    // 2) penumbra: lumina ortografica -> proportionala cu distanta receiver - blocker
+    float avgBlocker = blockerSum / blockers;
+    float radius = clamp((ref - avgBlocker) * PCSS_PENUMBRA_SCALE, 1.0, PCSS_MAX_RADIUS);
+
+    // 3) filtrare cu raza calculata
+    float lit = PoissonLit(projCoords, ref, radius, texelSize);
+#else
+    float lit = PoissonLit(projCoords, ref, POISSON_RADIUS, texelSize);
+#endif
+#endif
+
+    return 1.0 - lit; // 0 = lit, 1 = full shadow
+}
+
+// P = pozitie eye space, N = normala eye space (normalizata)
+vec3 ShadeScene(vec3 P, vec3 N, vec3 albedo, vec4 posLightSpace)
+{
+    vec3 V = normalize(-P);
+
+    // Directional
+    vec3 Ld = normalize(lightDir);
+
+    float ambientStrength = 0.30;
+    vec3 ambient = ambientStrength * lightColor;
+
+    float diffD = max(dot(N, Ld), 0.0);
+    vec3 diffuseD = diffD * lightColor;
+
+    float specularStrength = 0.08;
+    vec3 Rd = reflect(-Ld, N);
+    float specD = pow(max(dot(V, Rd), 0.0), 64.0);
+    vec3 specularD = specularStrength * specD * lightColor;
+
+    // SHADOW apply only on directional diffuse/spec (not on ambient)
+    float shadow = 0.0;
+    if (enableShadows == 1) {
+        shadow = ShadowFactor(posLightSpace, N, Ld);
+    }
+
+    vec3 color = ambient * albedo
+               + (1.0 - shadow) * (diffuseD * albedo + specularD);
+
+    // Point lights (unshadowed for simplicity)
+    // IMPORTANT: atenuare mai "blanda" ca sa se vada in oras + ceata
+    float constant = 1.0;
+    float linear = 0.02;
+    float quadratic = 0.001;
+
+    // boost ca sa fie vizibil (mai ales cu fog)
+    float pointIntensity = 6.0;
+
+    if (numPointLights > 0)
+    {
+        // clusterul fragmentului: tile din gl_FragCoord + slice exponential din adancime
+        float viewZ = -P.z;
+        int slice = 0;
+        if (viewZ >= clusterNearSliceZ) {
+            slice = min(clusterDims.z - 1, 1 + int(floor(log(viewZ / clusterNearSliceZ) * clusterLogScale)));
+        }
+        ivec2 tile = min(ivec2(gl_FragCoord.xy / clusterTileSize), clusterDims.xy - 1);
+        int cluster = (slice * clusterDims.y + tile.y) * clusterDims.x + tile.x;
+
+        uvec2 range = texelFetch(clusterGrid, cluster).xy;
+
+        for (uint k = 0u; k < range.y; k++)
+        {
+            int li = int(texelFetch(clusterLightIndices, int(range.x + k)).r);
+            vec4 posRadius = texelFetch(pointLights, 2 * li);
+            vec3 lightCol = texelFetch(pointLights, 2 * li + 1).rgb;
+
+            vec3 Lvec = posRadius.xyz - P;
+            float dist = length(Lvec);
+            vec3 Lp = Lvec / max(dist, 1e-6);
+
+            float att = 1.0 / (constant + linear * dist + quadratic * dist * dist);
+
+            // fereastra care duce lumina la 0 exact la raza (altfel clusterele n-ar fi corecte)
+            float w = clamp(1.0 - pow(dist / posRadius.w, 4.0), 0.0, 1.0);
+            att *= w * w;
+
+            float diffP = max(dot(N, Lp), 0.0);
+            vec3 diffuseP = diffP * lightCol * pointIntensity;
+
+            vec3 Rp = reflect(-Lp, N);
+            float specP = pow(max(dot(V, Rp), 0.0), 64.0);
+            vec3 specularP = 0.06 * specP * lightCol * pointIntensity;
+
+            color += att * ((diffuseP * albedo) + specularP);
+        }
+    }
+
+    return clamp(color, 0.0, 1.0);
+}
@@ -0,0 +1,23 @@
+// =========================
+// CROSS-FADE GEOMETRIE <-> IMPOSTOR (dithering ordonat 4x4, fara blending si fara sortare)
+// geometria pastreaza pixelii cu prag >= fade, impostorul pe cei cu prag < fade,
+// deci fiecare pixel e acoperit de exact unul dintre ei
+// =========================
+#ifndef LOD_FADE_GLSL
+#define LOD_FADE_GLSL
+
+const float bayer4x4[16] = float[](
+     0.0 / 16.0,  8.0 / 16.0,  2.0 / 16.0, 10.0 / 16.0,
+    12.0 / 16.0,  4.0 / 16.0, 14.0 / 16.0,  6.0 / 16.0,
+     3.0 / 16.0, 11.0 / 16.0,  1.0 / 16.0,  9.0 / 16.0,
+    15.0 / 16.0,  7.0 / 16.0, 13.0 / 16.0,  5.0 / 16.0
+);
+
+// prag in [0, 1) pentru pixelul curent
+float LodFadeThreshold()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy) & 3;
+    return bayer4x4[p.y * 4 + p.x];
+}
+
+#endif
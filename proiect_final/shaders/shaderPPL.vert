@@ -5,12 +5,12 @@ layout(location=1) in vec3 vNormal;
 layout(location=2) in vec2 vTexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// inverse-transpose al modelului (WORLD); view-ul e rigid, deci mat3(view) duce normala in eye space
 uniform mat3 normalMatrix;
 
-// NEW
-uniform mat4 lightSpaceMatrix;
+// view, projection, lightSpaceMatrix: CameraBlock
+#include "uniformBlocks.glsl"
+#include "vertexFormat.glsl"
 
 out vec3 fragPosEye;
 out vec3 fragNormalEye;
@@ -19,13 +19,17 @@ out vec2 fragTexCoords;
 // NEW
 out vec4 fragPosLightSpace;
 
+// depth pre-pass (depthPrepass.vert) + GL_EQUAL: pozitia trebuie sa fie identica
+invariant gl_Position;
+
 void main()
 {
-    vec4 posWorld = model * vec4(vPosition, 1.0);
+    vec4 posWorld = model * (vInstanceMatrix * vec4(decodePosition(vPosition), 1.0));
     vec4 posEye = view * posWorld;
 
+    // instantele sunt rigide: mat3(vInstanceMatrix) roteste normala corect
     fragPosEye = posEye.xyz;
-    fragNormalEye = normalize(normalMatrix * vNormal);
+    fragNormalEye = normalize(mat3(view) * (normalMatrix * (mat3(vInstanceMatrix) * vNormal)));
     fragTexCoords = vTexCoords;
 
     // NEW
@@ -3,9 +3,13 @@
 layout(location=0) in vec3 vPosition;
 
 uniform mat4 model;
-uniform mat4 lightSpaceMatrix;
+
+// lightSpaceMatrix: CameraBlock
+#include "uniformBlocks.glsl"
+// vInstanceMatrix (pozitiile vin mereu float, din depth stream-ul Model3D)
+#include "vertexFormat.glsl"
 
 void main()
 {
-    gl_Position = lightSpaceMatrix * model * vec4(vPosition, 1.0);
+    gl_Position = lightSpaceMatrix * model * (vInstanceMatrix * vec4(vPosition, 1.0));
 }
@@ -6,8 +6,8 @@ out vec4 color;
 uniform samplerCube skybox;
 
 // optional: tinem skybox-ul inghitit de ceata
-uniform vec3 fogColor;
-uniform float skyboxFog; // 0..1 (ex: 0.6)
+// fogColor, skyboxFog (0..1, ex: 0.6): FogBlock
+#include "uniformBlocks.glsl"
 
 void main()
 {
@@ -1,19 +1,21 @@
 #version 410 core
 
-layout (location = 0) in vec3 vertexPosition;
-
 out vec3 textureCoordinates;
 
-uniform mat4 projection;
-uniform mat4 view;
+// invView, invProjection: CameraBlock
+#include "uniformBlocks.glsl"
 
 void main()
 {
-    // view vine deja fara translatie din SkyBox::Draw (mat4(mat3(view)))
-    vec4 pos = projection * view * vec4(vertexPosition, 1.0);
+    // un singur triunghi care acopera tot ecranul: (-1,-1), (3,-1), (-1,3)
+    vec2 ndc = vec2((gl_VertexID == 1) ? 3.0 : -1.0,
+                    (gl_VertexID == 2) ? 3.0 : -1.0);
 
-    // trucul de skybox: fortam depth = 1.0
-    gl_Position = pos.xyww;
+    // trucul de skybox: depth = 1.0 (z == w)
+    gl_Position = vec4(ndc, 1.0, 1.0);
 
-    textureCoordinates = vertexPosition;
+    // directia de privire: punctul de pe planul far (eye space), rotit in WORLD fara translatie
+    // (liniara in NDC, deci se interpoleaza corect)
+    vec4 farPoint = invProjection * vec4(ndc, 1.0, 1.0);
+    textureCoordinates = mat3(invView) * (farPoint.xyz / farPoint.w);
 }
@@ -0,0 +1,33 @@
+// =========================
+// UNIFORM BLOCKS (std140), comune tuturor programelor
+// un singur buffer per bloc, scris o data pe frame (vezi updateFrameUniformBlocks in main.cpp);
+// binding-urile se fac din aplicatie (glUniformBlockBinding), GLSL 4.10 nu are layout(binding)
+// ATENTIE: layout-ul trebuie sa ramana identic cu structurile *BlockData din main.cpp
+// =========================
+#ifndef UNIFORM_BLOCKS_GLSL
+#define UNIFORM_BLOCKS_GLSL
+
+layout(std140) uniform CameraBlock {
+    mat4 view;
+    mat4 projection;
+    mat4 invView;
+    mat4 invProjection;
+    mat4 lightSpaceMatrix;   // WORLD -> clip space al luminii (umbre)
+};
+
+layout(std140) uniform LightingBlock {
+    vec3 lightDir;           // directional, eye space, spre lumina
+    int numPointLights;      // 0 => lampi oprite (tasta 2)
+    vec3 lightColor;         // 0 cand lumina directionala e oprita (tasta 1)
+    int enableShadows;       // 0/1
+};
+
+layout(std140) uniform FogBlock {
+    vec3 fogColor;
+    float fogStart;
+    float fogEnd;
+    int fogEnabled;          // 0/1
+    float skyboxFog;         // 0..1
+};
+
+#endif
@@ -0,0 +1,32 @@
+// =========================
+// FORMAT VERTEX (gps::VertexFormat)
+// VERTEX_FLOAT: pozitia vine direct in coordonate MODEL
+// VERTEX_PACKED (#define PACKED_VERTICES): unorm16 in cutia mesh-ului, setata per mesh
+//   (Mesh::setDequantizeUniforms); normala 10:10:10:2 si UV half ajung deja ca float
+// ATENTIE: shaderPPL.vert si depthPrepass.vert trebuie sa decodeze la fel (GL_EQUAL)
+//
+// INSTANTE (recuzita repetata, gps::Mesh::getInstances): matricea MODEL-LOCAL a copiei vine la
+// locatiile 3..6 (divisor 1); mesh-urile fara instante au atributele dezactivate si citesc
+// valoarea constanta, identitatea (Mesh::setDefaultInstanceMatrix)
+// =========================
+#ifndef VERTEX_FORMAT_GLSL
+#define VERTEX_FORMAT_GLSL
+
+#ifdef PACKED_VERTICES
+uniform vec3 posScale;
+uniform vec3 posOffset;
+
+vec3 decodePosition(vec3 p)
+{
+    return posOffset + posScale * p;
+}
+#else
+vec3 decodePosition(vec3 p)
+{
+    return p;
+}
+#endif
+
+layout(location=3) in mat4 vInstanceMatrix;
+
+#endif
@@ -0,0 +1,67 @@
+#include "Test.hpp"
+#include "Camera.hpp"
+
+#include <cmath>
+
+static bool near(float a, float b, float eps = 1e-4f)
+{
+    return std::fabs(a - b) <= eps;
+}
+
+static bool near(const glm::vec3& a, const glm::vec3& b, float eps = 1e-4f)
+{
+    return near(a.x, b.x, eps) && near(a.y, b.y, eps) && near(a.z, b.z, eps);
+}
+
+WT_TEST(cameraLooksAtTarget)
+{
+    gps::Camera camera(glm::vec3(1.0f, 2.0f, 3.0f), glm::vec3(1.0f, 2.0f, -7.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    WT_CHECK(near(camera.getPosition(), glm::vec3(1.0f, 2.0f, 3.0f)));
+    WT_CHECK(near(camera.getFront(), glm::vec3(0.0f, 0.0f, -1.0f)));
+    WT_CHECK(near(camera.getRight(), glm::vec3(1.0f, 0.0f, 0.0f)));
+
+    // the view matrix puts the camera at the origin, looking down -Z
+    glm::mat4 view = camera.getViewMatrix();
+    glm::vec4 eye = view * glm::vec4(camera.getPosition(), 1.0f);
+    glm::vec4 ahead = view * glm::vec4(camera.getPosition() + camera.getFront() * 5.0f, 1.0f);
+    WT_CHECK(near(glm::vec3(eye.x, eye.y, eye.z), glm::vec3(0.0f, 0.0f, 0.0f)));
+    WT_CHECK(near(glm::vec3(ahead.x, ahead.y, ahead.z), glm::vec3(0.0f, 0.0f, -5.0f)));
+}
+
+WT_TEST(cameraMovesAlongItsAxes)
+{
+    gps::Camera camera(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    camera.move(gps::MOVE_FORWARD, 2.0f);
+    WT_CHECK(near(camera.getPosition(), glm::vec3(0.0f, 0.0f, -2.0f)));
+
+    camera.move(gps::MOVE_RIGHT, 0.5f);
+    WT_CHECK(near(camera.getPosition(), glm::vec3(0.5f, 0.0f, -2.0f)));
+
+    camera.move(gps::MOVE_BACKWARD, 2.0f);
+    camera.move(gps::MOVE_LEFT, 0.5f);
+    WT_CHECK(near(camera.getPosition(), glm::vec3(0.0f, 0.0f, 0.0f)));
+
+    // setPosition keeps the viewing direction
+    camera.setPosition(glm::vec3(4.0f, 1.0f, 4.0f));
+    WT_CHECK(near(camera.getFront(), glm::vec3(0.0f, 0.0f, -1.0f)));
+}
+
+WT_TEST(cameraRotationClampsPitch)
+{
+    gps::Camera camera(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    // yaw grows towards +Z: a quarter turn faces +X
+    camera.rotate(0.0f, 90.0f);
+    WT_CHECK(near(camera.getFront(), glm::vec3(1.0f, 0.0f, 0.0f)));
+
+    // never straight up, so right = front x up stays defined
+    camera.rotate(500.0f, 0.0f);
+    glm::vec3 front = camera.getFront();
+    WT_CHECK(near(std::asin(front.y), glm::radians(89.0f), 1e-3f));
+    WT_CHECK(near(glm::length(camera.getRight()), 1.0f));
+
+    camera.rotate(-1000.0f, 0.0f);
+    WT_CHECK(near(std::asin(camera.getFront().y), glm::radians(-89.0f), 1e-3f));
+}
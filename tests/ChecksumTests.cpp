@@ -0,0 +1,50 @@
+#include "Test.hpp"
+#include "Checksum.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static const unsigned char* bytesOf(const char* text)
+{
+    return (const unsigned char*)text;
+}
+
+WT_TEST(crc32MatchesReferenceValues)
+{
+    WT_CHECK(gps::crc32(nullptr, 0) == 0u);
+    WT_CHECK(gps::crc32(bytesOf("123456789"), 9) == 0xCBF43926u);
+    // the CRC of PNG's empty IEND chunk covers only its type
+    WT_CHECK(gps::crc32(bytesOf("IEND"), 4) == 0xAE426082u);
+}
+
+WT_TEST(crc32ContinuesAcrossBuffers)
+{
+    const char* text = "The quick brown fox jumps over the lazy dog";
+    size_t size = std::strlen(text);
+    uint32_t whole = gps::crc32(bytesOf(text), size);
+    uint32_t split = gps::crc32(bytesOf(text) + 10, size - 10, gps::crc32(bytesOf(text), 10));
+    WT_CHECK(whole == 0x414FA339u);
+    WT_CHECK(split == whole);
+}
+
+WT_TEST(adler32MatchesReferenceValues)
+{
+    WT_CHECK(gps::adler32(nullptr, 0) == 1u);
+    WT_CHECK(gps::adler32(bytesOf("Wikipedia"), 9) == 0x11E60398u);
+}
+
+WT_TEST(adler32ContinuesAcrossBlocks)
+{
+    // large enough for both sums to wrap modulo 65521, split like the PNG writer's stored blocks
+    std::vector<unsigned char> data(200000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = (unsigned char)(i * 31 + 7);
+
+    uint32_t whole = gps::adler32(data.data(), data.size());
+    uint32_t blocks = 1;
+    for (size_t offset = 0; offset < data.size(); offset += 65535) {
+        size_t len = std::min<size_t>(65535, data.size() - offset);
+        blocks = gps::adler32(data.data() + offset, len, blocks);
+    }
+    WT_CHECK(blocks == whole);
+}
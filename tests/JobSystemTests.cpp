@@ -0,0 +1,73 @@
+#include "Test.hpp"
+#include "JobSystem.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// every index of [0, count) visited exactly once, whatever the chunking and worker count
+static bool coversRangeOnce(gps::JobSystem& jobs, size_t count, size_t grain)
+{
+    std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[count]);
+    for (size_t i = 0; i < count; i++) visits[i] = 0;
+
+    jobs.parallelFor(count, grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) visits[i]++;
+    });
+
+    for (size_t i = 0; i < count; i++) {
+        if (visits[i] != 1) return false;
+    }
+    return true;
+}
+
+WT_TEST(parallelForCoversTheRange)
+{
+    for (int workers : { 0, 1, 3 }) {
+        gps::JobSystem jobs(workers);
+        WT_CHECK(coversRangeOnce(jobs, 1, 1));
+        WT_CHECK(coversRangeOnce(jobs, 1000, 1));
+        WT_CHECK(coversRangeOnce(jobs, 1000, 64));
+        WT_CHECK(coversRangeOnce(jobs, 1001, 1000));
+        WT_CHECK(coversRangeOnce(jobs, 100000, 256));
+    }
+
+    gps::JobSystem jobs(2);
+    bool called = false;
+    jobs.parallelFor(0, 1, [&](size_t, size_t) { called = true; });
+    WT_CHECK(!called);
+}
+
+WT_TEST(runAfterStartsOnceTheDependencyIsDone)
+{
+    gps::JobSystem jobs(3);
+
+    const int kJobs = 64;
+    std::atomic<int> finished{ 0 };
+    std::atomic<int> seenByContinuation{ -1 };
+    std::atomic<int> seenBySecond{ -1 };
+
+    gps::JobCounter first, second, third;
+    for (int i = 0; i < kJobs; i++) {
+        jobs.run([&]() { finished++; }, &first);
+    }
+    jobs.runAfter(first, [&]() { seenByContinuation = finished.load(); }, &second);
+    jobs.runAfter(second, [&]() { seenBySecond = seenByContinuation.load(); }, &third);
+
+    jobs.wait(third);
+    WT_CHECK(first.isDone());
+    WT_CHECK(second.isDone());
+    WT_CHECK(seenByContinuation == kJobs);
+    WT_CHECK(seenBySecond == kJobs);
+}
+
+WT_TEST(runAfterOnAFinishedDependencyRunsImmediately)
+{
+    gps::JobSystem jobs(0);
+
+    gps::JobCounter done, after;
+    std::atomic<bool> ran{ false };
+    jobs.runAfter(done, [&]() { ran = true; }, &after);
+    jobs.wait(after);
+    WT_CHECK(ran);
+}
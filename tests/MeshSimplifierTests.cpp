@@ -0,0 +1,158 @@
+#include "Test.hpp"
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+typedef std::pair<GLuint, GLuint> Edge;
+
+// n x n quads on a gently curved sheet (flat sheets collapse without error, which proves little)
+static void makeSheet(int n, std::vector<gps::Vertex>& vertices, std::vector<GLuint>& indices)
+{
+    for (int z = 0; z <= n; z++) {
+        for (int x = 0; x <= n; x++) {
+            gps::Vertex v;
+            float fx = (float)x / n, fz = (float)z / n;
+            v.Position = glm::vec3(fx, 0.05f * (fx * fx + fz * fz), fz);
+            v.Normal = glm::vec3(0.0f, 1.0f, 0.0f);
+            v.TexCoords = glm::vec2(fx, fz);
+            vertices.push_back(v);
+        }
+    }
+
+    for (int z = 0; z < n; z++) {
+        for (int x = 0; x < n; x++) {
+            GLuint i0 = z * (n + 1) + x, i1 = i0 + 1, i2 = i0 + (n + 1), i3 = i2 + 1;
+            indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+        }
+    }
+}
+
+// edges used by exactly one triangle (undirected)
+static std::set<Edge> openEdges(const std::vector<GLuint>& indices)
+{
+    std::map<Edge, int> uses;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        for (int k = 0; k < 3; k++) {
+            GLuint a = indices[t + k], b = indices[t + (k + 1) % 3];
+            uses[{ std::min(a, b), std::max(a, b) }]++;
+        }
+    }
+
+    std::set<Edge> open;
+    for (const auto& kv : uses) {
+        if (kv.second == 1) open.insert(kv.first);
+    }
+    return open;
+}
+
+WT_TEST(simplifierReducesTriangles)
+{
+    std::vector<gps::Vertex> vertices;
+    std::vector<GLuint> indices;
+    makeSheet(16, vertices, indices);
+    size_t original = indices.size() / 3;
+
+    gps::MeshSimplifier simplifier(vertices, indices);
+    WT_CHECK(simplifier.getTriangleCount() == original);
+
+    simplifier.simplifyTo(original / 2);
+    std::vector<GLuint> half = simplifier.getIndices();
+    WT_CHECK(simplifier.getTriangleCount() < original);
+    WT_CHECK(half.size() == simplifier.getTriangleCount() * 3);
+
+    // progressive: a lower target never brings triangles back
+    size_t halfCount = simplifier.getTriangleCount();
+    simplifier.simplifyTo(original / 8);
+    WT_CHECK(simplifier.getTriangleCount() <= halfCount);
+
+    // the LOD still indexes the original vertex buffer, without degenerate triangles
+    bool valid = true;
+    std::vector<GLuint> lod = simplifier.getIndices();
+    for (size_t t = 0; t + 2 < lod.size(); t += 3) {
+        if (lod[t] >= vertices.size() || lod[t + 1] >= vertices.size() || lod[t + 2] >= vertices.size()) valid = false;
+        if (lod[t] == lod[t + 1] || lod[t + 1] == lod[t + 2] || lod[t] == lod[t + 2]) valid = false;
+    }
+    WT_CHECK(valid);
+    WT_CHECK(simplifier.getError() >= 0.0f);
+}
+
+WT_TEST(simplifierKeepsOpenEdges)
+{
+    std::vector<gps::Vertex> vertices;
+    std::vector<GLuint> indices;
+    makeSheet(12, vertices, indices);
+    std::set<Edge> border = openEdges(indices);
+
+    gps::MeshSimplifier simplifier(vertices, indices);
+    simplifier.simplifyTo(1);
+
+    // the border (a chunk / material seam in a real mesh) is exactly where it was
+    WT_CHECK(openEdges(simplifier.getIndices()) == border);
+}
+
+WT_TEST(simplifierKeepsWeldSeams)
+{
+    // two sheets side by side with duplicated vertices on the shared column (a UV seam after welding)
+    const int n = 8;
+    std::vector<gps::Vertex> vertices, right;
+    std::vector<GLuint> indices, rightIndices;
+    makeSheet(n, vertices, indices);
+    makeSheet(n, right, rightIndices);
+
+    GLuint base = (GLuint)vertices.size();
+    for (auto& v : right) {
+        v.Position.x += 1.0f;
+        v.TexCoords.x += 5.0f;
+        vertices.push_back(v);
+    }
+    for (GLuint i : rightIndices) indices.push_back(base + i);
+
+    std::set<GLuint> seam;
+    for (GLuint i = 0; i < vertices.size(); i++) {
+        if (vertices[i].Position.x == 1.0f) seam.insert(i);
+    }
+
+    gps::MeshSimplifier simplifier(vertices, indices);
+    simplifier.simplifyTo(indices.size() / 3 / 4);
+    std::vector<GLuint> lod = simplifier.getIndices();
+    WT_CHECK(lod.size() < indices.size());
+
+    // every seam vertex is still used, on both sides: the two halves cannot pull apart
+    std::set<GLuint> used(lod.begin(), lod.end());
+    bool seamKept = true;
+    for (GLuint i : seam) {
+        if (!used.count(i)) seamKept = false;
+    }
+    WT_CHECK(seamKept);
+}
+
+WT_TEST(simplifierErrorIsADistance)
+{
+    std::vector<gps::Vertex> vertices;
+    std::vector<GLuint> indices;
+    makeSheet(16, vertices, indices);
+
+    gps::MeshSimplifier simplifier(vertices, indices);
+    simplifier.simplifyTo(indices.size() / 3 / 4);
+
+    // the sheet bends by 0.1 at most: no collapse can move the surface further than that
+    float error = simplifier.getError();
+    WT_CHECK(error > 0.0f);
+    WT_CHECK(error <= 0.1f);
+
+    // scaling the mesh scales the error by the same factor (an area-weighted cost would grow
+    // with the square), so selectLods can compare it with a projected pixel size
+    const float scale = 10.0f;
+    std::vector<gps::Vertex> scaled = vertices;
+    for (auto& v : scaled) v.Position = v.Position * scale;
+
+    gps::MeshSimplifier scaledSimplifier(scaled, indices);
+    scaledSimplifier.simplifyTo(indices.size() / 3 / 4);
+    WT_CHECK(scaledSimplifier.getTriangleCount() == simplifier.getTriangleCount());
+    WT_CHECK(std::fabs(scaledSimplifier.getError() - scale * error) <= 1e-3f * scale * error);
+}
@@ -0,0 +1,56 @@
+#include "Test.hpp"
+#include "StreamBuffer.hpp"
+
+typedef gps::StreamBuffer::Placement Placement;
+
+WT_TEST(streamPlacementAligns)
+{
+    Placement p = gps::StreamBuffer::place(0, 1000, 100, 64);
+    WT_CHECK(p.start == 0 && p.offset == 0 && !p.wrapped);
+
+    p = gps::StreamBuffer::place(100, 1000, 100, 64);
+    WT_CHECK(p.start == 128 && p.offset == 128 && !p.wrapped);
+
+    // already aligned, or no alignment asked for
+    p = gps::StreamBuffer::place(256, 1000, 100, 64);
+    WT_CHECK(p.start == 256 && p.offset == 256);
+    p = gps::StreamBuffer::place(101, 1000, 100, 1);
+    WT_CHECK(p.start == 101 && p.offset == 101);
+}
+
+WT_TEST(streamPlacementNeverSplitsAcrossTheEnd)
+{
+    // fits exactly up to the end
+    Placement p = gps::StreamBuffer::place(900, 1000, 100, 4);
+    WT_CHECK(p.start == 900 && p.offset == 900 && !p.wrapped);
+
+    // does not fit: the whole allocation moves to the next lap
+    p = gps::StreamBuffer::place(900, 1000, 150, 4);
+    WT_CHECK(p.start == 1000 && p.offset == 0 && p.wrapped);
+
+    // alignment padding that itself runs past the end (size not a multiple of the alignment)
+    p = gps::StreamBuffer::place(990, 1000, 8, 64);
+    WT_CHECK(p.start == 1000 && p.offset == 0 && p.wrapped);
+}
+
+WT_TEST(streamPlacementUsesAbsolutePositions)
+{
+    // third lap: the offset is the position modulo the size
+    Placement p = gps::StreamBuffer::place(2100, 1000, 100, 64);
+    WT_CHECK(p.start == 2128 && p.offset == 128 && !p.wrapped);
+
+    p = gps::StreamBuffer::place(2950, 1000, 100, 16);
+    WT_CHECK(p.start == 3000 && p.offset == 0 && p.wrapped);
+
+    // a ring of many allocations: always inside the buffer, aligned, and moving forward
+    unsigned long long head = 0;
+    bool valid = true;
+    for (int i = 0; i < 10000; i++) {
+        GLsizeiptr bytes = 16 + (i * 37) % 400;
+        Placement q = gps::StreamBuffer::place(head, 1000, bytes, 256);
+        if (q.start < head || q.offset % 256 != 0 || q.offset + bytes > 1000
+            || (GLsizeiptr)(q.start % 1000) != q.offset) valid = false;
+        head = q.start + bytes;
+    }
+    WT_CHECK(valid);
+}
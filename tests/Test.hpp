@@ -0,0 +1,49 @@
+#ifndef Test_hpp
+#define Test_hpp
+
+#include <iostream>
+#include <vector>
+
+namespace wt_test {
+
+    // Minimal self-registering test runner (no framework dependency): every WT_TEST body runs
+    // once from main(); a failed WT_CHECK prints file:line and marks the test failed.
+    typedef void (*TestFunction)();
+
+    struct TestCase {
+        const char* name;
+        TestFunction run;
+    };
+
+    inline std::vector<TestCase>& registry()
+    {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, TestFunction run) { registry().push_back({ name, run }); }
+    };
+}
+
+#define WT_TEST(name)                                                       \
+    static void name();                                                     \
+    static wt_test::Registrar name##Registrar(#name, &name);               \
+    static void name()
+
+#define WT_CHECK(condition)                                                 \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: "  \
+                << #condition << "\n";                                      \
+            wt_test::failures()++;                                          \
+        }                                                                   \
+    } while (0)
+
+#endif /* Test_hpp */
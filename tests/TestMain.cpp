@@ -0,0 +1,16 @@
+#include "Test.hpp"
+
+int main()
+{
+    int failedTests = 0;
+    for (const auto& test : wt_test::registry()) {
+        int before = wt_test::failures();
+        test.run();
+        bool passed = wt_test::failures() == before;
+        if (!passed) failedTests++;
+        std::cout << (passed ? "[ PASS ] " : "[ FAIL ] ") << test.name << "\n";
+    }
+
+    std::cout << wt_test::registry().size() - failedTests << " / " << wt_test::registry().size() << " tests passed\n";
+    return failedTests == 0 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include "Test.hpp"
+#include "TripleBuffer.hpp"
+
+#include <atomic>
+#include <thread>
+
+WT_TEST(tripleBufferLatestValueWins)
+{
+    gps::TripleBuffer<int> buffer;
+    WT_CHECK(!buffer.acquire());
+
+    for (int value = 1; value <= 3; value++) {
+        buffer.writeSlot() = value;
+        buffer.publish();
+    }
+
+    WT_CHECK(buffer.acquire());
+    WT_CHECK(buffer.readSlot() == 3);
+
+    // nothing new: the read slot stays put
+    WT_CHECK(!buffer.acquire());
+    WT_CHECK(buffer.readSlot() == 3);
+
+    buffer.writeSlot() = 4;
+    buffer.publish();
+    WT_CHECK(buffer.acquire());
+    WT_CHECK(buffer.readSlot() == 4);
+}
+
+WT_TEST(tripleBufferConsumerNeverGoesBack)
+{
+    struct Packet {
+        int value;
+        int copy;   // written with value: a torn read would show a mismatch
+    };
+
+    const int kLast = 200000;
+    gps::TripleBuffer<Packet> buffer;
+    std::atomic<bool> done{ false };
+
+    std::thread producer([&]() {
+        for (int value = 1; value <= kLast; value++) {
+            buffer.writeSlot() = { value, value };
+            buffer.publish();
+        }
+        done = true;
+    });
+
+    int last = 0;
+    bool monotonic = true, consistent = true;
+    while (last != kLast) {
+        bool finished = done.load();
+        if (buffer.acquire()) {
+            const Packet& packet = buffer.readSlot();
+            if (packet.value < last) monotonic = false;
+            if (packet.value != packet.copy) consistent = false;
+            last = packet.value;
+        }
+        else if (finished) {
+            break;
+        }
+    }
+    producer.join();
+
+    WT_CHECK(monotonic);
+    WT_CHECK(consistent);
+    WT_CHECK(last == kLast);
+}